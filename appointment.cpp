@@ -1,11 +1,12 @@
 #include "appointment.h"
 #include "utils.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
 #include <vector>
 #include <fstream>
 using namespace std;
-Appointment::Appointment(int id, int pid, int did, string d, string t, string s, string r): appointmentID(id), patientID(pid), doctorID(did),date(d), time(t), status(s), reason(r) {}
+Appointment::Appointment(int id, int pid, int did, string d, string t, string s, string r): appointmentID(id), patientID(pid), doctorID(did),date(std::move(d)), time(std::move(t)), status(std::move(s)), reason(std::move(r)) {}
 AppointmentNode::AppointmentNode(Appointment* appt): appointment(appt), next(nullptr) {}
 AppointmentManager::DoctorQueue::DoctorQueue(int did): doctorID(did), front(nullptr), rear(nullptr) {}
 AppointmentManager::AppointmentManager() : appointmentCounter(0) {
@@ -28,7 +29,7 @@ void AppointmentManager::enqueue(int doctorID, Appointment* appointment) {//Queu
         return;
     if (doctorQueues[doctorID] == nullptr)
         doctorQueues[doctorID] = new DoctorQueue(doctorID);
-    AppointmentNode* newNode = new AppointmentNode(appointment);
+    AppointmentNode* newNode = queueNodes.create(appointment);
 
     if (doctorQueues[doctorID]->rear == nullptr) {
         doctorQueues[doctorID]->front = newNode;
@@ -51,7 +52,7 @@ Appointment* AppointmentManager::dequeue(int doctorID) {
     if (doctorQueues[doctorID]->front == nullptr)
         doctorQueues[doctorID]->rear = nullptr;
 
-    delete temp;
+    queueNodes.destroy(temp);
     return appointment;
 }
 bool AppointmentManager::isQueueEmpty(int doctorID) {
@@ -63,7 +64,7 @@ bool AppointmentManager::isQueueEmpty(int doctorID) {
 void AppointmentManager::clearQueue(int doctorID) {
     while (!isQueueEmpty(doctorID)) {
         Appointment* appt = dequeue(doctorID);
-        delete appt;
+        appointments.destroy(appt);
     }
 }
 
@@ -94,7 +95,7 @@ void AppointmentManager::bookAppointment() {
     string reason = getValidString("Enter Reason for Visit: ");
 
     Appointment* newAppointment =
-        new Appointment(appointmentID, patientID, doctorID, date, time, "Scheduled", reason);
+        appointments.create(appointmentID, patientID, doctorID, std::move(date), std::move(time), "Scheduled", std::move(reason));
 
     enqueue(doctorID, newAppointment);
     cout << endl << "Appointment booked successfully!" << endl;
@@ -189,7 +190,7 @@ void AppointmentManager::loadFromFile() {
         getline(iss, status, '|');
         getline(iss, reason, '|');
 
-        Appointment* appt = new Appointment(id, pid, did, date, time, status, reason);
+        Appointment* appt = appointments.create(id, pid, did, std::move(date), std::move(time), std::move(status), std::move(reason));
         enqueue(did, appt);
     }
     file.close();
@@ -3,6 +3,7 @@
 #include <string>
 #include <fstream>
 #include <queue>
+#include "nodePool.h"
 struct Appointment {
     int appointmentID;
     int patientID;
@@ -39,6 +40,8 @@ private:
     static const int MAX_DOCTORS = 1000;
     DoctorQueue* doctorQueues[MAX_DOCTORS];
     int appointmentCounter;
+    NodePool<Appointment> appointments; // Slab storage for the records
+    NodePool<AppointmentNode> queueNodes; // and for the queue links
     
     // Helper functions
     void enqueue(int doctorID, Appointment* appointment);
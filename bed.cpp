@@ -1,10 +1,11 @@
 #include "bed.h"
 #include "utils.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
 Bed::Bed(int id, int ward, std::string type, bool occupied, int pid, std::string date, double charge)
-    : bedID(id), wardNumber(ward), bedType(type), isOccupied(occupied),
-      patientID(pid), allocationDate(date), dailyCharge(charge), next(nullptr) {}
+    : bedID(id), wardNumber(ward), bedType(std::move(type)), isOccupied(occupied),
+      patientID(pid), allocationDate(std::move(date)), dailyCharge(charge), next(nullptr) {}
 BedManager::BedManager() : head(nullptr), bedCounter(0)
 {
     loadFromFile();
@@ -17,7 +18,7 @@ BedManager::~BedManager()
     {
         Bed *temp = current;
         current = current->next;
-        delete temp;
+        nodes.destroy(temp);
     }
 }
 
@@ -64,7 +65,7 @@ void BedManager::addBed()
     std::string bedType = getValidString("Enter Bed Type (General/ICU/Private/Semi-Private): ");
     double dailyCharge = getValidInt("Enter Daily Charge: ");
 
-    Bed *newBed = new Bed(bedID, wardNumber, bedType, false, -1, "", dailyCharge);
+    Bed *newBed = nodes.create(bedID, wardNumber, bedType, false, -1, "", dailyCharge);
 
     newBed->next = head;
     head = newBed;
@@ -245,11 +246,9 @@ void BedManager::loadFromFile()
             std::getline(iss, date, '|');
 
             if (!type.empty() && type[0] == ' ')
-                type = type.substr(1);
-            if (date.empty())
-                date = "";
+                type.erase(0, 1);
 
-            Bed *newBed = new Bed(id, ward, type, occupied, patientID, date, charge);
+            Bed *newBed = nodes.create(id, ward, std::move(type), occupied, patientID, std::move(date), charge);
             newBed->next = head;
             head = newBed;
 
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <fstream>
+#include "nodePool.h"
 
 // Bed structure
 struct Bed {
@@ -25,6 +26,7 @@ struct Bed {
 class BedManager {
 private:
     Bed* head;
+    NodePool<Bed> nodes; // Slab storage for the list nodes
     int bedCounter;
     
     // Helper functions
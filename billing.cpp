@@ -1,20 +1,47 @@
 #include "billing.h"
 #include "utils.h"
+#include "pharmacy.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <set>
 
 using namespace std;
 
+// Bill items are stored as "qty price name" entries separated by ';' inside
+// a '|' field, so neither character may appear in an item name
+static bool hasFieldSeparator(const string& text) {
+    return text.find_first_of(";|") != string::npos;
+}
+
+// One prescription as written to dispense_journal.txt
+struct DispenseLine {
+    int medicineID;
+    int quantity;
+    double unitPrice;
+    int stockBefore; // Medicine quantity before the prescription
+    string name;
+};
+
+struct DispenseRecord {
+    int billID;
+    int patientID;
+    size_t itemsBefore; // Items on the bill before the prescription
+    string date;
+    vector<DispenseLine> lines;
+};
+
 // BillItem constructor
 BillItem::BillItem(string name, int qty, double price)
-    : itemName(name), quantity(qty), unitPrice(price) {
+    : itemName(std::move(name)), quantity(qty), unitPrice(price) {
     totalPrice = quantity * unitPrice;
 }
 
 // Bill constructor
 Bill::Bill(int id, int pid, string d, double cf, double bc)
-    : billID(id), patientID(pid), date(d), consultationFee(cf),
+    : billID(id), patientID(pid), date(std::move(d)), consultationFee(cf),
       bedCharges(bc), totalAmount(0.0), status("Pending"), next(nullptr) {
     totalAmount = consultationFee + bedCharges;
 }
@@ -31,7 +58,7 @@ BillingManager::~BillingManager() {
     while (current != nullptr) {
         Bill* temp = current;
         current = current->next;
-        delete temp;
+        nodes.destroy(temp);
     }
 }
 
@@ -46,6 +73,26 @@ Bill* BillingManager::findBill(int billID) {
     }
     return nullptr;
 }
+// Find the patient's most recent pending bill
+Bill* BillingManager::findOpenBill(int patientID) {
+    Bill* current = head;
+    while (current != nullptr) {
+        if (current->patientID == patientID && current->status == "Pending") {
+            return current;
+        }
+        current = current->next;
+    }
+    return nullptr;
+}
+
+int BillingManager::nextBillID() {
+    int maxID = 0;
+    for (Bill* current = head; current != nullptr; current = current->next) {
+        if (current->billID > maxID) maxID = current->billID;
+    }
+    return maxID + 1;
+}
+
 double BillingManager::calculateTotal(Bill* bill) {
     if (bill == nullptr) return 0.0;
 
@@ -104,11 +151,14 @@ void BillingManager::generateBill() {
     double consultationFee = getValidInt("Enter Consultation Fee: ");
     double bedCharges = getValidInt("Enter Bed Charges (0 if not applicable): ");
 
-    Bill* newBill = new Bill(billID, patientID, date, consultationFee, bedCharges);
+    Bill* newBill = nodes.create(billID, patientID, date, consultationFee, bedCharges);
 
     char addMore = 'y';
     while (addMore == 'y' || addMore == 'Y') {
         string itemName = getValidString("Enter Item Name: ");
+        while (hasFieldSeparator(itemName)) {
+            itemName = getValidString("Item name cannot contain ';' or '|'! Please enter again: ");
+        }
         int quantity = getValidInt("Enter Quantity: ");
         double unitPrice = getValidInt("Enter Unit Price: ");
 
@@ -218,3 +268,297 @@ void BillingManager::sortBillsByAmount() {
     cout << "Bills sorted by amount successfully!" << endl;
     viewAllBills();
 }
+
+// Add item to an existing bill
+void BillingManager::addItemToBill(int billID, string itemName, int quantity, double unitPrice) {
+    Bill* bill = findBill(billID);
+    if (bill == nullptr) {
+        cout << "Bill with ID " << billID << " not found!" << endl;
+        return;
+    }
+    if (hasFieldSeparator(itemName)) {
+        cout << "Item name cannot contain ';' or '|'!" << endl;
+        return;
+    }
+
+    bill->items.push_back(BillItem(itemName, quantity, unitPrice));
+    bill->totalAmount = calculateTotal(bill);
+    saveToFile();
+}
+
+// Dispense a prescription: every line is reserved in the pharmacy first, so
+// a missing medicine or shortage cancels the whole prescription. Once all
+// lines are reserved a write-ahead record goes to the dispense journal, the
+// stock is committed, the items are priced from the pharmacy and appended to
+// the patient's open bill, and a "+<billID> <itemsBefore>" line marks the
+// record complete after both managers have saved. recoverDispenses() finishes
+// any record left incomplete.
+bool BillingManager::dispensePrescription(PharmacyManager& pharmacy, int patientID,
+                                          const vector<pair<int, int>>& items) {
+    if (items.empty()) {
+        cout << "Prescription is empty!" << endl;
+        return false;
+    }
+
+    vector<string> names;
+    vector<double> prices;
+    vector<int> stockBefore;
+    for (const auto& item : items) {
+        names.push_back(pharmacy.getMedicineName(item.first));
+        prices.push_back(pharmacy.getMedicinePrice(item.first));
+        stockBefore.push_back(pharmacy.getMedicineQuantity(item.first));
+        if (hasFieldSeparator(names.back())) {
+            cout << "Medicine " << item.first << " cannot be billed: its name contains ';' or '|'." << endl;
+            cout << "Prescription cancelled. No stock or bill was changed." << endl;
+            return false;
+        }
+    }
+
+    size_t reserved = 0;
+    while (reserved < items.size() &&
+           pharmacy.reserveStock(items[reserved].first, items[reserved].second)) {
+        reserved++;
+    }
+
+    Bill* bill = findOpenBill(patientID);
+    int billID = bill != nullptr ? bill->billID : nextBillID();
+    size_t itemsBefore = bill != nullptr ? bill->items.size() : 0;
+    string date = getCurrentDate();
+    ofstream journal;
+    if (reserved == items.size()) journal.open("dispense_journal.txt", ios::app);
+
+    if (!journal.is_open()) {
+        if (reserved < items.size()) {
+            cout << "Cannot dispense " << items[reserved].second << " x medicine "
+                 << items[reserved].first << " (not found or insufficient stock)." << endl;
+        } else {
+            cout << "Cannot open the dispense journal." << endl;
+        }
+        cout << "Prescription cancelled. No stock or bill was changed." << endl;
+        for (size_t i = 0; i < reserved; i++) {
+            pharmacy.releaseStock(items[i].first, items[i].second);
+        }
+        return false;
+    }
+
+    journal << billID << " " << patientID << " " << itemsBefore << " |" << date << "|";
+    for (size_t i = 0; i < items.size(); i++) {
+        journal << items[i].first << " " << items[i].second << " " << prices[i] << " "
+                << stockBefore[i] << " " << names[i];
+        if (i < items.size() - 1) journal << ";";
+    }
+    journal << "|" << endl;
+    journal.close();
+
+    if (bill == nullptr) {
+        bill = nodes.create(billID, patientID, date, 0.0, 0.0);
+        bill->next = head;
+        head = bill;
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+        pharmacy.commitDispense(items[i].first, items[i].second);
+        bill->items.push_back(BillItem(names[i], items[i].second, prices[i]));
+    }
+    bill->totalAmount = calculateTotal(bill);
+
+    pharmacy.saveToFile();
+    saveToFile();
+    finishDispense(billID, itemsBefore);
+
+    cout << "Prescription dispensed: " << items.size() << " item(s) added to Bill "
+         << billID << "." << endl;
+    return true;
+}
+
+void BillingManager::finishDispense(int billID, size_t itemsBefore) {
+    ofstream journal("dispense_journal.txt", ios::app);
+    journal << "+" << billID << " " << itemsBefore << endl;
+}
+
+// Finish the prescriptions whose journal record was never marked complete
+// (the program stopped part way through). Each side is compared with the
+// state the record captured: a medicine whose quantity still equals its
+// stock before the prescription was not saved, nor was a bill that still has
+// its earlier item count. Sides that did not reach disk are rolled forward;
+// a record matching neither state is reported and left in place.
+void BillingManager::recoverDispenses(PharmacyManager& pharmacy) {
+    ifstream journal("dispense_journal.txt");
+    if (!journal.is_open()) return;
+
+    vector<DispenseRecord> records;
+    set<pair<int, size_t>> finished;
+    string line;
+    while (getline(journal, line)) {
+        if (line.empty()) continue;
+
+        istringstream iss(line);
+        if (line[0] == '+') {
+            int billID;
+            size_t itemsBefore;
+            iss.ignore(1);
+            if (iss >> billID >> itemsBefore) finished.insert(make_pair(billID, itemsBefore));
+            continue;
+        }
+
+        // Records from before recovery was added carry no item count and are skipped
+        DispenseRecord record;
+        string itemsStr;
+        if (!(iss >> record.billID >> record.patientID >> record.itemsBefore)) continue;
+        getline(iss, record.date, '|');
+        getline(iss, record.date, '|');
+        getline(iss, itemsStr, '|');
+
+        istringstream itemsIss(itemsStr);
+        string entry;
+        while (getline(itemsIss, entry, ';')) {
+            istringstream eIss(entry);
+            DispenseLine item;
+            if (eIss >> item.medicineID >> item.quantity >> item.unitPrice >> item.stockBefore) {
+                getline(eIss, item.name);
+                if (!item.name.empty() && item.name[0] == ' ') item.name.erase(0, 1);
+                record.lines.push_back(std::move(item));
+            }
+        }
+        if (!record.lines.empty()) records.push_back(std::move(record));
+    }
+    journal.close();
+
+    int recovered = 0;
+    for (const DispenseRecord& record : records) {
+        if (finished.count(make_pair(record.billID, record.itemsBefore))) continue;
+
+        // Medicine ID -> (stock before, total quantity dispensed)
+        map<int, pair<int, int>> stock;
+        for (const DispenseLine& item : record.lines) {
+            stock[item.medicineID].first = item.stockBefore;
+            stock[item.medicineID].second += item.quantity;
+        }
+        bool stockSaved = true;
+        bool stockUnsaved = true;
+        for (const auto& entry : stock) {
+            int quantity = pharmacy.getMedicineQuantity(entry.first);
+            if (quantity != entry.second.first - entry.second.second) stockSaved = false;
+            if (quantity != entry.second.first) stockUnsaved = false;
+        }
+
+        Bill* bill = findBill(record.billID);
+        bool billSaved = bill != nullptr && bill->patientID == record.patientID &&
+                         bill->items.size() >= record.itemsBefore + record.lines.size();
+        bool billUnsaved = bill == nullptr ? record.itemsBefore == 0
+                                           : bill->patientID == record.patientID &&
+                                             bill->items.size() == record.itemsBefore;
+
+        if ((!stockSaved && !stockUnsaved) || (!billSaved && !billUnsaved)) {
+            cout << "Dispense journal: the prescription for Bill " << record.billID
+                 << " does not match the saved stock or bill. Please review it." << endl;
+            continue;
+        }
+
+        // Reserve every line before committing any, as dispensePrescription does
+        if (stockUnsaved) {
+            size_t reserved = 0;
+            while (reserved < record.lines.size() &&
+                   pharmacy.reserveStock(record.lines[reserved].medicineID, record.lines[reserved].quantity)) {
+                reserved++;
+            }
+            if (reserved < record.lines.size()) {
+                for (size_t i = 0; i < reserved; i++) {
+                    pharmacy.releaseStock(record.lines[i].medicineID, record.lines[i].quantity);
+                }
+                cout << "Dispense journal: the prescription for Bill " << record.billID
+                     << " cannot be completed (medicine " << record.lines[reserved].medicineID
+                     << " is missing or short). Please review it." << endl;
+                continue;
+            }
+            for (const DispenseLine& item : record.lines) {
+                pharmacy.commitDispense(item.medicineID, item.quantity);
+            }
+            pharmacy.saveToFile();
+        }
+        if (billUnsaved) {
+            if (bill == nullptr) {
+                bill = nodes.create(record.billID, record.patientID, record.date, 0.0, 0.0);
+                bill->next = head;
+                head = bill;
+            }
+            for (const DispenseLine& item : record.lines) {
+                bill->items.push_back(BillItem(item.name, item.quantity, item.unitPrice));
+            }
+            bill->totalAmount = calculateTotal(bill);
+            saveToFile();
+        }
+        finishDispense(record.billID, record.itemsBefore);
+        recovered++;
+    }
+
+    if (recovered > 0) {
+        cout << "Completed " << recovered << " interrupted prescription dispense(s)." << endl;
+    }
+}
+
+// Load bills from file (items are stored as "qty price name" entries separated by ';')
+void BillingManager::loadFromFile() {
+    ifstream file("billing.txt");
+    if (!file.is_open()) return;
+
+    Bill* tail = nullptr;
+    string line;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+
+        istringstream iss(line);
+        int id, patientID;
+        double consultationFee, bedCharges;
+        string date, status, itemsStr;
+
+        if (iss >> id >> patientID >> consultationFee >> bedCharges) {
+            getline(iss, date, '|');
+            getline(iss, date, '|');
+            getline(iss, status, '|');
+            getline(iss, itemsStr, '|');
+
+            Bill* bill = nodes.create(id, patientID, std::move(date), consultationFee, bedCharges);
+            if (!status.empty()) bill->status = std::move(status);
+
+            istringstream itemsIss(itemsStr);
+            string entry;
+            while (getline(itemsIss, entry, ';')) {
+                istringstream eIss(entry);
+                int quantity;
+                double unitPrice;
+                string itemName;
+                if (eIss >> quantity >> unitPrice) {
+                    getline(eIss, itemName);
+                    if (!itemName.empty() && itemName[0] == ' ') itemName.erase(0, 1);
+                    bill->items.emplace_back(std::move(itemName), quantity, unitPrice);
+                }
+            }
+            bill->totalAmount = calculateTotal(bill);
+
+            // Append to keep the file order
+            if (tail == nullptr) head = bill;
+            else tail->next = bill;
+            tail = bill;
+        }
+    }
+    file.close();
+}
+
+// Save bills to file
+void BillingManager::saveToFile() {
+    ofstream file("billing.txt");
+    if (!file.is_open()) return;
+
+    for (Bill* current = head; current != nullptr; current = current->next) {
+        file << current->billID << " " << current->patientID << " "
+             << current->consultationFee << " " << current->bedCharges << " |"
+             << current->date << "|" << current->status << "|";
+        for (size_t i = 0; i < current->items.size(); i++) {
+            const BillItem& item = current->items[i];
+            file << item.quantity << " " << item.unitPrice << " " << item.itemName;
+            if (i < current->items.size() - 1) file << ";";
+        }
+        file << "|\n";
+    }
+    file.close();
+}
@@ -4,6 +4,10 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <utility>
+#include "nodePool.h"
+
+class PharmacyManager;
 
 // Bill Item structure
 struct BillItem {
@@ -37,11 +41,15 @@ struct Bill {
 class BillingManager {
 private:
     Bill* head;
+    NodePool<Bill> nodes; // Slab storage for the list nodes
     
     // Helper functions
     Bill* findBill(int billID);
     void displayBill(Bill* bill);
     double calculateTotal(Bill* bill);
+    Bill* findOpenBill(int patientID);
+    int nextBillID();
+    void finishDispense(int billID, size_t itemsBefore);
     
 public:
     BillingManager();
@@ -55,6 +63,14 @@ public:
     void addItemToBill(int billID, std::string itemName, int quantity, double unitPrice);
     void markBillPaid(int billID);
     
+    // Dispense a whole prescription onto the patient's open bill (all-or-nothing)
+    bool dispensePrescription(PharmacyManager& pharmacy, int patientID,
+                              const std::vector<std::pair<int, int>>& items);
+    
+    // Complete the dispenses the journal shows as interrupted (run once both
+    // managers have loaded)
+    void recoverDispenses(PharmacyManager& pharmacy);
+    
     // File operations
     void loadFromFile();
     void saveToFile();
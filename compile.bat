@@ -1,6 +1,7 @@
 @echo off
+rem Benchmark build: add -DHMS_COUNT_ALLOCATIONS to count heap allocations
 echo Compiling HMS project...
-g++ main.cpp utils.cpp patient.cpp doctor.cpp appointment.cpp bed.cpp pharmacy.cpp billing.cpp hospitalGraph.cpp -o HMS.exe
+g++ main.cpp utils.cpp patient.cpp patientColumns.cpp doctor.cpp appointment.cpp bed.cpp pharmacy.cpp billing.cpp hospitalGraph.cpp -o HMS.exe
 if %errorlevel% neq 0 (
     echo Compilation failed!
     pause
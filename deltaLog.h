@@ -0,0 +1,131 @@
+#ifndef DELTA_LOG_H
+#define DELTA_LOG_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include "utils.h"
+
+// Incremental persistence for an IndexedStore of ID-keyed records: the base
+// file holds the last full snapshot and the delta log the records changed
+// since ("-<id>" lines mark deletions). save() appends the pending changes
+// and compacts once the log outgrows the record count, which keeps the
+// amortized cost per change constant. The record format stays with the
+// owning manager through the writer callback.
+//
+// Compaction appends the pending changes first, so the log always ends with
+// the newest version of every record it mentions, then writes the snapshot
+// to a temporary file and renames it over the base file; the log is removed
+// last. A crash at any point leaves a snapshot (old or new) whose log
+// replays to the current state.
+//
+// markDirty/markDeleted may be called from several threads; save() and
+// compact() need the store to be stable (the owner's lock, if any).
+template <typename Store>
+class DeltaLog {
+public:
+    typedef typename Store::RecordType Record;
+    typedef std::function<void(const Record&, std::ofstream&)> Writer;
+
+private:
+    static const size_t COMPACT_MIN = 256;
+
+    const Store& store;
+    std::string baseFile;
+    std::string deltaFile;
+    Writer write;
+
+    std::set<int> dirtyIDs;
+    std::set<int> deletedIDs;
+    size_t deltaRecords; // Lines currently in the delta log
+    std::mutex mutex;
+
+    // Caller holds mutex
+    void appendPending() {
+        if (dirtyIDs.empty() && deletedIDs.empty()) return;
+        std::ofstream file(deltaFile.c_str(), std::ios::app);
+        if (!file.is_open()) return;
+        for (int id : dirtyIDs) {
+            const Record* record = store.find(id);
+            if (record != nullptr) write(*record, file);
+        }
+        for (int id : deletedIDs) file << "-" << id << "\n";
+        file.close();
+
+        deltaRecords += dirtyIDs.size() + deletedIDs.size();
+        dirtyIDs.clear();
+        deletedIDs.clear();
+    }
+
+    // Caller holds mutex
+    void compactLocked() {
+        appendPending();
+        std::string tempFile = baseFile + ".tmp";
+        std::ofstream file(tempFile.c_str());
+        if (!file.is_open()) return;
+        store.forEach([this, &file](const Record& record) { write(record, file); });
+        file.close();
+        if (file.fail() || !replaceFile(tempFile, baseFile)) return;
+        std::remove(deltaFile.c_str());
+        deltaRecords = 0;
+    }
+
+public:
+    DeltaLog(const Store& store, std::string baseFile, std::string deltaFile, Writer write)
+        : store(store), baseFile(std::move(baseFile)), deltaFile(std::move(deltaFile)),
+          write(std::move(write)), deltaRecords(0) {}
+
+    void markDirty(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        deletedIDs.erase(id);
+        dirtyIDs.insert(id);
+    }
+
+    void markDeleted(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dirtyIDs.erase(id);
+        deletedIDs.insert(id);
+    }
+
+    // Feeds the snapshot and then the delta log to the owner, in file order:
+    // applyLine(line, fromDelta) for records, applyDelete(id) for deletions
+    template <typename ApplyLine, typename ApplyDelete>
+    void replay(ApplyLine applyLine, ApplyDelete applyDelete) {
+        const std::string* files[] = {&baseFile, &deltaFile};
+        for (int pass = 0; pass < 2; pass++) {
+            bool fromDelta = pass == 1;
+            std::ifstream file(files[pass]->c_str());
+            std::string line;
+            while (file.is_open() && std::getline(file, line)) {
+                if (line.empty()) continue;
+                if (fromDelta) deltaRecords++;
+                if (fromDelta && line[0] == '-') {
+                    applyDelete(std::atoi(line.c_str() + 1));
+                    continue;
+                }
+                applyLine(line, fromDelta);
+            }
+        }
+    }
+
+    void save() {
+        std::lock_guard<std::mutex> lock(mutex);
+        appendPending();
+        if (deltaRecords > std::max(COMPACT_MIN, store.size())) compactLocked();
+    }
+
+    void compact() {
+        std::lock_guard<std::mutex> lock(mutex);
+        compactLocked();
+    }
+};
+
+template <typename Store>
+const size_t DeltaLog<Store>::COMPACT_MIN;
+
+#endif
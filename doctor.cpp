@@ -1,114 +1,61 @@
 #include "doctor.h"
+#include "recordFields.h"
 #include "utils.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
 #include <algorithm>
 using namespace std;
 
-Doctor::Doctor(int id, string n, string spec, string dept, string ph, string em, string qual, double fee): doctorID(id), name(n), specialization(spec), department(dept), phone(ph), email(em), qualification(qual), consultationFee(fee), left(nullptr), right(nullptr) {}
+// Key of one (doctor, patient) pair in the assignment set
+static unsigned long long assignmentKey(int doctorID, int patientID) {
+    return static_cast<unsigned long long>(static_cast<unsigned int>(doctorID)) << 32 |
+           static_cast<unsigned int>(patientID);
+}
+
+Doctor::Doctor(int id, string n, string spec, string dept, string ph, string em, string qual, double fee): doctorID(id), name(std::move(n)), specialization(std::move(spec)), department(std::move(dept)), phone(std::move(ph)), email(std::move(em)), qualification(std::move(qual)), consultationFee(fee) {}
+
+// doctors.txt line: "id fee |name|specialization|department|phone|email|qualification|patient IDs|"
+typedef RecordFormat<Doctor,
+                     FieldList<Field<Doctor, int, &Doctor::doctorID>,
+                               Field<Doctor, double, &Doctor::consultationFee>>,
+                     FieldList<Field<Doctor, string, &Doctor::name>,
+                               Field<Doctor, string, &Doctor::specialization>,
+                               Field<Doctor, string, &Doctor::department>,
+                               Field<Doctor, string, &Doctor::phone>,
+                               Field<Doctor, string, &Doctor::email>,
+                               Field<Doctor, string, &Doctor::qualification>,
+                               Field<Doctor, vector<int>, &Doctor::assignedPatients>>>
+    DoctorFormat;
 
-DoctorManager::DoctorManager() : root(nullptr) {
+DoctorManager::DoctorManager()
+    : deltaLog(records, "doctors.txt", "doctors_delta.txt", DoctorFormat::write) {
+    records.attachIndex([this](Doctor& doctor) { indexAssignments(&doctor); },
+                        [this](Doctor& doctor) { unindexAssignments(&doctor); });
     loadFromFile();
 }
 DoctorManager::~DoctorManager() {
-    saveToFile();
-    clearTree(root);
+    compactFile();
 }
-Doctor* DoctorManager::insertBST(Doctor* node, Doctor* newDoctor) {
-    if (node == nullptr) {
-        return newDoctor;
-    }
-    
-    if (newDoctor->doctorID < node->doctorID) {
-        node->left = insertBST(node->left, newDoctor);
-    } else if (newDoctor->doctorID > node->doctorID) {
-        node->right = insertBST(node->right, newDoctor);
-    }
-    
-    return node;
-}
-Doctor* DoctorManager::searchBST(Doctor* node, int id) {
-    if (node == nullptr || node->doctorID == id) {
-        return node;
-    }
-    
-    if (id < node->doctorID) {
-        return searchBST(node->left, id);
-    } else {
-        return searchBST(node->right, id);
-    }
-}
-Doctor* DoctorManager::findMin(Doctor* node) {
-    while (node->left != nullptr) {
-        node = node->left;
-    }
-    return node;
-}
-
-Doctor* DoctorManager::deleteBST(Doctor* node, int id) {
-    if (node == nullptr) {
-        return node;
-    }
-    
-    if (id < node->doctorID) {
-        node->left = deleteBST(node->left, id);
-    } else if (id > node->doctorID) {
-        node->right = deleteBST(node->right, id);
-    } else {
-        if (node->left == nullptr) {
-            Doctor* temp = node->right;
-            delete node;
-            return temp;
-        } else if (node->right == nullptr) {
-            Doctor* temp = node->left;
-            delete node;
-            return temp;
-        }
-        
-        Doctor* temp = findMin(node->right);
-        node->doctorID = temp->doctorID;
-        node->name = temp->name;
-        node->specialization = temp->specialization;
-        node->department = temp->department;
-        node->phone = temp->phone;
-        node->email = temp->email;
-        node->qualification = temp->qualification;
-        node->consultationFee = temp->consultationFee;
-        node->assignedPatients = temp->assignedPatients;
-        
-        node->right = deleteBST(node->right, temp->doctorID);
-    }
-    
-    return node;
-}
-void DoctorManager::inorderTraversal(Doctor* node) {
-    if (node != nullptr) {
-        inorderTraversal(node->left);
-        cout << "----------------------------------------" << endl;
-        cout << "Doctor ID: " << node->doctorID << endl;
-        cout << "Name: " << node->name << endl;
-        cout << "Specialization: " << node->specialization << endl;
-        cout << "Department: " << node->department << endl;
-        cout << "Phone: " << node->phone << endl;
-        cout << "Email: " << node->email << endl;
-        cout << "Qualification: " << node->qualification << endl;
-        cout << "Consultation Fee: " << formatCurrency(node->consultationFee) << endl;
-        cout << "Assigned Patients: " << node->assignedPatients.size() << endl;
-        inorderTraversal(node->right);
-    }
-}
-void getAllDoctorIDsHelper(Doctor* node, vector<int>& ids) {
-    if (node != nullptr) {
-        getAllDoctorIDsHelper(node->left, ids);
-        ids.push_back(node->doctorID);
-        getAllDoctorIDsHelper(node->right, ids);
-    }
+void DoctorManager::displayDoctor(const Doctor& doctor) {
+    cout << "----------------------------------------" << endl;
+    cout << "Doctor ID: " << doctor.doctorID << endl;
+    cout << "Name: " << doctor.name << endl;
+    cout << "Specialization: " << doctor.specialization << endl;
+    cout << "Department: " << doctor.department << endl;
+    cout << "Phone: " << doctor.phone << endl;
+    cout << "Email: " << doctor.email << endl;
+    cout << "Qualification: " << doctor.qualification << endl;
+    cout << "Consultation Fee: " << formatCurrency(doctor.consultationFee) << endl;
+    cout << "Assigned Patients: " << doctor.assignedPatients.size() << endl;
 }
 void DoctorManager::registerDoctor() {
     clearScreen();
     cout << "========== REGISTER NEW DOCTOR ==========" << endl << endl;
     
-    int id = generateID("doctors.txt");
+    // Next ID after the largest in memory (the data file may lag behind the delta log)
+    Doctor* lastDoctor = records.last();
+    int id = lastDoctor != nullptr ? lastDoctor->doctorID + 1 : 1;
     cout << "Generated Doctor ID: " << id << endl << endl;
     
     string name = getValidString("Enter Doctor Name: ");
@@ -119,8 +66,10 @@ void DoctorManager::registerDoctor() {
     string qualification = getValidString("Enter Qualification: ");
     double fee = getValidInt("Enter Consultation Fee: ");
     
-    Doctor* newDoctor = new Doctor(id, name, specialization, department, phone, email, qualification, fee);
-    root = insertBST(root, newDoctor);
+    Doctor* newDoctor = records.create(id, std::move(name), std::move(specialization), std::move(department),
+                                       std::move(phone), std::move(email), std::move(qualification), fee);
+    records.insert(newDoctor);
+    deltaLog.markDirty(id);
     
     cout << endl << "Doctor registered successfully!" << endl;
     saveToFile();
@@ -128,7 +77,7 @@ void DoctorManager::registerDoctor() {
 }
 
 void DoctorManager::viewDoctor(int id) {
-    Doctor* doctor = searchBST(root, id);
+    Doctor* doctor = records.find(id);
     if (doctor != nullptr) {
         cout << "========== DOCTOR DETAILS ==========" << endl;
         cout << "Doctor ID: " << doctor->doctorID << endl;
@@ -149,17 +98,17 @@ void DoctorManager::viewDoctor(int id) {
 void DoctorManager::viewAllDoctors() {
     clearScreen();
     cout << "========== ALL DOCTORS ==========" << endl;
-    if (root == nullptr) {
+    if (records.empty()) {
         cout << "No doctors registered yet." << endl;
     } else {
-        inorderTraversal(root);
+        records.forEach([this](const Doctor& doctor) { displayDoctor(doctor); });
     }
     cout << "=====================================" << endl;
     pause();
 }
 
 void DoctorManager::updateInfo(int id) {
-    Doctor* doctor = searchBST(root, id);
+    Doctor* doctor = records.find(id);
     if (doctor == nullptr) {
         cout << "Doctor with ID " << id << " not found!" << endl;
         pause();
@@ -202,29 +151,50 @@ void DoctorManager::updateInfo(int id) {
     getline(cin, input);
     if (!input.empty()) doctor->consultationFee = stod(input);
     
+    deltaLog.markDirty(id);
     cout << endl << "Doctor information updated successfully!" << endl;
     saveToFile();
     pause();
 }
 
 void DoctorManager::assignPatient(int doctorID, int patientID) {
-    Doctor* doctor = searchBST(root, doctorID);
+    Doctor* doctor = records.find(doctorID);
     if (doctor == nullptr) {
         cout << "Doctor with ID " << doctorID << " not found!" << endl;
         return;
     }
     
-    if (find(doctor->assignedPatients.begin(), doctor->assignedPatients.end(), patientID) != doctor->assignedPatients.end()) {
+    if (!linkAssignment(doctorID, patientID)) {
         cout << "Patient already assigned to this doctor!" << endl;
         return;
     }
-    doctor->assignedPatients.push_back(patientID);
+    vector<int>& patients = doctor->assignedPatients;
+    patients.insert(lower_bound(patients.begin(), patients.end(), patientID), patientID);
+    deltaLog.markDirty(doctorID);
     cout << "Patient " << patientID << " assigned to Doctor " << doctor->name << " successfully!" << endl;
     saveToFile();
 }
 
+void DoctorManager::unassignPatient(int doctorID, int patientID) {
+    Doctor* doctor = records.find(doctorID);
+    if (doctor == nullptr) {
+        cout << "Doctor with ID " << doctorID << " not found!" << endl;
+        return;
+    }
+    if (!isAssigned(doctorID, patientID)) {
+        cout << "Patient is not assigned to this doctor!" << endl;
+        return;
+    }
+    unlinkAssignment(doctorID, patientID);
+    vector<int>& patients = doctor->assignedPatients;
+    patients.erase(lower_bound(patients.begin(), patients.end(), patientID));
+    deltaLog.markDirty(doctorID);
+    cout << "Patient " << patientID << " unassigned from Doctor " << doctor->name << "." << endl;
+    saveToFile();
+}
+
 void DoctorManager::viewAssignedPatients(int doctorID) {
-    Doctor* doctor = searchBST(root, doctorID);
+    Doctor* doctor = records.find(doctorID);
     if (doctor == nullptr) {
         cout << "Doctor with ID " << doctorID << " not found!" << endl;
         return;
@@ -245,83 +215,124 @@ void DoctorManager::viewAssignedPatients(int doctorID) {
     }
     cout << "======================================" << endl;
 }
+
+void DoctorManager::viewPatientDoctors(int patientID) {
+    vector<int> doctorIDs = getDoctorsForPatient(patientID);
+    cout << "========== PATIENT'S DOCTORS ==========" << endl;
+    cout << "Patient ID: " << patientID << endl << endl;
+    if (doctorIDs.empty()) {
+        cout << "Not assigned to any doctor." << endl;
+    } else {
+        for (int doctorID : doctorIDs) {
+            Doctor* doctor = records.find(doctorID);
+            cout << doctorID << ". " << doctor->name << " (" << doctor->specialization << ")" << endl;
+        }
+    }
+    cout << "======================================" << endl;
+}
 bool DoctorManager::doctorExists(int id) {
-    return searchBST(root, id) != nullptr;
+    return records.find(id) != nullptr;
 }
 
 vector<int> DoctorManager::getAllDoctorIDs() {
     vector<int> ids;
-    getAllDoctorIDsHelper(root, ids);
+    records.forEach([&ids](const Doctor& doctor) { ids.push_back(doctor.doctorID); });
     return ids;
 }
 
-void DoctorManager::loadFromFile() {
-    ifstream file("doctors.txt");
-    if (!file.is_open()) return;
-    
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-        
-        istringstream iss(line);
-        int id;
-        double fee;
-        string name, specialization, department, phone, email, qualification;
-        
-        if (iss >> id >> fee) {
-            getline(iss, name, '|');
-            getline(iss, name, '|');
-            getline(iss, specialization, '|');
-            getline(iss, department, '|');
-            getline(iss, phone, '|');
-            getline(iss, email, '|');
-            getline(iss, qualification, '|');
-            
-            if (!name.empty() && name[0] == ' ') name = name.substr(1);
-            
-            Doctor* newDoctor = new Doctor(id, name, specialization, department, phone, email, qualification, fee);
-            
-            string patientsStr;
-            getline(iss, patientsStr, '|');
-            if (!patientsStr.empty()) {
-                istringstream pIss(patientsStr);
-                int patientID;
-                while (pIss >> patientID) newDoctor->assignedPatients.push_back(patientID);
-            }
-            
-            root = insertBST(root, newDoctor);
-        }
+vector<int> DoctorManager::getAssignedPatients(int doctorID) {
+    Doctor* doctor = records.find(doctorID);
+    if (doctor == nullptr) return vector<int>();
+    return doctor->assignedPatients;
+}
+
+bool DoctorManager::isAssigned(int doctorID, int patientID) {
+    return assignments.count(assignmentKey(doctorID, patientID)) > 0;
+}
+
+vector<int> DoctorManager::getDoctorsForPatient(int patientID) {
+    auto it = doctorsByPatient.find(patientID);
+    if (it == doctorsByPatient.end()) return vector<int>();
+    return it->second;
+}
+
+size_t DoctorManager::removePatientAssignments(int patientID) {
+    vector<int> doctorIDs = getDoctorsForPatient(patientID);
+    for (int doctorID : doctorIDs) {
+        unlinkAssignment(doctorID, patientID);
+        Doctor* doctor = records.find(doctorID);
+        vector<int>& patients = doctor->assignedPatients;
+        patients.erase(lower_bound(patients.begin(), patients.end(), patientID));
+        deltaLog.markDirty(doctorID);
     }
-    file.close();
+    if (!doctorIDs.empty()) saveToFile();
+    return doctorIDs.size();
 }
-void DoctorManager::saveToFileHelper(Doctor* node, ofstream& file) {
-    if (node != nullptr) {
-        saveToFileHelper(node->left, file);
-        file << node->doctorID << " " << node->consultationFee << " |" << node->name 
-             << "|" << node->specialization << "|" << node->department << "|" 
-             << node->phone << "|" << node->email << "|" << node->qualification << "|";
-        
-        for (size_t i = 0; i < node->assignedPatients.size(); i++) {
-            file << node->assignedPatients[i];
-            if (i < node->assignedPatients.size() - 1) file << " ";
-        }
-        file << "|\n";
-        
-        saveToFileHelper(node->right, file);
+
+// Adds the pair to both sides of the index; false if it was already there
+bool DoctorManager::linkAssignment(int doctorID, int patientID) {
+    unsigned long long key = assignmentKey(doctorID, patientID);
+    if (!assignments.insert(key).second) return false;
+    vector<int>& doctorIDs = doctorsByPatient[patientID];
+    doctorIDs.insert(lower_bound(doctorIDs.begin(), doctorIDs.end(), doctorID), doctorID);
+    return true;
+}
+
+void DoctorManager::unlinkAssignment(int doctorID, int patientID) {
+    unsigned long long key = assignmentKey(doctorID, patientID);
+    if (assignments.erase(key) == 0) return;
+    auto it = doctorsByPatient.find(patientID);
+    vector<int>& doctorIDs = it->second;
+    doctorIDs.erase(lower_bound(doctorIDs.begin(), doctorIDs.end(), doctorID));
+    if (doctorIDs.empty()) doctorsByPatient.erase(it);
+}
+
+// Store index hook: sorts the doctor's list, drops duplicate entries and links every pair
+void DoctorManager::indexAssignments(Doctor* doctor) {
+    vector<int>& patients = doctor->assignedPatients;
+    sort(patients.begin(), patients.end());
+    patients.erase(unique(patients.begin(), patients.end()), patients.end());
+    for (int patientID : patients) linkAssignment(doctor->doctorID, patientID);
+}
+
+void DoctorManager::unindexAssignments(Doctor* doctor) {
+    for (int patientID : doctor->assignedPatients) unlinkAssignment(doctor->doctorID, patientID);
+}
+
+Doctor* DoctorManager::parseRecord(const string& line) {
+    Doctor* newDoctor = records.create(0, "", "", "", "", "", "", 0.0);
+    if (!DoctorFormat::read(line, *newDoctor)) {
+        records.destroy(newDoctor);
+        return nullptr;
     }
+    return newDoctor;
 }
+
+// Load the last full snapshot, then replay the delta log (later records
+// replace earlier ones with the same ID)
+void DoctorManager::loadFromFile() {
+    deltaLog.replay(
+        [this](const string& line, bool fromDelta) {
+            Doctor* newDoctor = parseRecord(line);
+            if (newDoctor == nullptr) return;
+            
+            if (records.contains(newDoctor->doctorID)) {
+                if (!fromDelta) {
+                    records.destroy(newDoctor);
+                    return;
+                }
+                records.erase(newDoctor->doctorID);
+            }
+            records.insert(newDoctor);
+        },
+        [this](int id) { records.erase(id); });
+}
+// Append the doctors changed since the last save to the delta log; rewrite
+// the full file once the log outgrows the record count
 void DoctorManager::saveToFile() {
-    ofstream file("doctors.txt");
-    if (file.is_open()) {
-        saveToFileHelper(root, file);
-        file.close();
-    }
+    deltaLog.save();
 }
 
-void DoctorManager::clearTree(Doctor* node) {
-    if (node != nullptr) {
-        clearTree(node->left);
-        clearTree(node->right);
-        delete node;
-    }
+void DoctorManager::compactFile() {
+    deltaLog.compact();
 }
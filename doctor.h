@@ -4,6 +4,10 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "indexedStore.h"
+#include "deltaLog.h"
 
 // Doctor structure
 struct Doctor {
@@ -16,11 +20,7 @@ struct Doctor {
     std::string qualification;
     double consultationFee;
     
-    // BST pointers
-    Doctor* left;
-    Doctor* right;
-    
-    // List of assigned patient IDs
+    // Assigned patient IDs, kept sorted
     std::vector<int> assignedPatients;
     
     // Constructor
@@ -28,19 +28,29 @@ struct Doctor {
            std::string ph, std::string em, std::string qual, double fee);
 };
 
+typedef IndexedStore<Doctor, int, &Doctor::doctorID> DoctorStore;
+
 // Doctor Management Class using BST
 class DoctorManager {
 private:
-    Doctor* root;
+    DoctorStore records;
+    
+    // Incremental persistence: changed records are appended to
+    // doctors_delta.txt and folded into doctors.txt on compaction
+    DeltaLog<DoctorStore> deltaLog;
+    
+    // Assignment index: every (doctor, patient) pair for O(1) duplicate
+    // checks, and per patient the sorted IDs of their doctors
+    std::unordered_set<unsigned long long> assignments;
+    std::unordered_map<int, std::vector<int>> doctorsByPatient;
     
     // Helper functions
-    Doctor* insertBST(Doctor* node, Doctor* newDoctor);
-    Doctor* searchBST(Doctor* node, int id);
-    Doctor* deleteBST(Doctor* node, int id);
-    Doctor* findMin(Doctor* node);
-    void inorderTraversal(Doctor* node);
-    void saveToFileHelper(Doctor* node, std::ofstream& file);
-    void clearTree(Doctor* node);
+    void displayDoctor(const Doctor& doctor);
+    Doctor* parseRecord(const std::string& line);
+    bool linkAssignment(int doctorID, int patientID);
+    void unlinkAssignment(int doctorID, int patientID);
+    void indexAssignments(Doctor* doctor);
+    void unindexAssignments(Doctor* doctor);
     
 public:
     DoctorManager();
@@ -52,17 +62,30 @@ public:
     void viewAllDoctors();
     void updateInfo(int id);
     void assignPatient(int doctorID, int patientID);
+    void unassignPatient(int doctorID, int patientID);
     void viewAssignedPatients(int doctorID);
+    void viewPatientDoctors(int patientID);
     
     // File operations
     void loadFromFile();
     void saveToFile();
+    void compactFile();
     
     // Check if doctor exists
     bool doctorExists(int id);
     
     // Get all doctor IDs
     std::vector<int> getAllDoctorIDs();
+    
+    // Get the patient IDs assigned to a doctor (empty if the doctor does not exist)
+    std::vector<int> getAssignedPatients(int doctorID);
+    
+    // Reverse lookups through the assignment index
+    bool isAssigned(int doctorID, int patientID);
+    std::vector<int> getDoctorsForPatient(int patientID);
+    
+    // Drop a deleted patient from every doctor's list; returns the number of doctors updated
+    size_t removePatientAssignments(int patientID);
 };
 
 #endif
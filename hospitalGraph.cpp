@@ -5,13 +5,26 @@
 #include <queue>
 #include <climits>
 #include <algorithm>
+#include <thread>
+#include <cmath>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
 
 // GraphNode constructor
 GraphNode::GraphNode(int id, std::string n, std::string t)
-    : nodeID(id), name(n), type(t) {}
+    : nodeID(id), index(-1), name(n), type(t), hasLocation(false), floor(0), x(0.0), y(0.0) {}
 
 // HospitalGraph constructor
-HospitalGraph::HospitalGraph() : nodeCounter(0) {
+HospitalGraph::HospitalGraph(bool persistent)
+    : nodeCounter(0), persistent(persistent), graphVersion(1), csrVersion(0), routeTableSize(0),
+      routeTableValid(false), componentCount(0), routeCacheCapacity(256), routeCacheVersion(0),
+      routeCacheHits(0), routeCacheMisses(0), routeCacheEvictions(0), routeCacheInvalidations(0) {
+    profileOffsets.push_back(0);
+    if (!persistent) {
+        return;
+    }
     loadFromFile();
     if (nodes.empty()) {
         initializeSampleData();
@@ -28,22 +41,68 @@ HospitalGraph::~HospitalGraph() {
 
 // Find node by ID
 GraphNode* HospitalGraph::findNode(int nodeID) {
-    for (auto node : nodes) {
-        if (node->nodeID == nodeID) {
-            return node;
-        }
-    }
-    return nullptr;
+    auto it = nodesByID.find(nodeID);
+    return it != nodesByID.end() ? it->second : nullptr;
 }
 
 // Find node by name
 GraphNode* HospitalGraph::findNodeByName(const std::string& name) {
-    for (auto node : nodes) {
-        if (node->name == name) {
-            return node;
+    auto it = nodesByName.find(name);
+    return it != nodesByName.end() ? it->second : nullptr;
+}
+
+// Key for an undirected edge: (min ID, max ID) packed into one integer
+long long HospitalGraph::edgeKey(int a, int b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<long long>(a) << 32) | static_cast<unsigned int>(b);
+}
+
+// Register a node with every index (no output, no saving)
+GraphNode* HospitalGraph::insertNode(int id, std::string name, std::string type) {
+    GraphNode* newNode = new GraphNode(id, name, type);
+    newNode->index = static_cast<int>(nodes.size());
+    nodes.push_back(newNode);
+    nodesByID[id] = newNode;
+    nodesByName[name] = newNode;
+    graphVersion++;
+    extendRouteTable();
+    componentParent.push_back(newNode->index);
+    componentRank.push_back(0);
+    componentCount++;
+    
+    if (id > nodeCounter) {
+        nodeCounter = id;
+    }
+    return newNode;
+}
+
+// Add or update an undirected edge (no output, no saving).
+// Returns true if the edge is new, false if an existing distance was updated.
+bool HospitalGraph::insertEdge(GraphNode* fromNode, GraphNode* toNode, int distance) {
+    if (edgeSet.insert(edgeKey(fromNode->nodeID, toNode->nodeID)).second) {
+        fromNode->neighbors.push_back({toNode, distance});
+        toNode->neighbors.push_back({fromNode, distance}); // Undirected graph
+        graphVersion++;
+        relaxRouteTable(fromNode->index, toNode->index, distance);
+        uniteComponents(fromNode->index, toNode->index);
+        return true;
+    }
+    
+    for (auto& neighbor : fromNode->neighbors) {
+        if (neighbor.first == toNode) {
+            if (distance < neighbor.second) {
+                relaxRouteTable(fromNode->index, toNode->index, distance);
+            } else if (distance > neighbor.second) {
+                routeTableValid = false;
+            }
+            neighbor.second = distance;
         }
     }
-    return nullptr;
+    for (auto& back : toNode->neighbors) {
+        if (back.first == fromNode) back.second = distance;
+    }
+    graphVersion++;
+    return false;
 }
 
 // Add new node
@@ -54,9 +113,8 @@ void HospitalGraph::addNode(std::string name, std::string type) {
         return;
     }
     
-    int id = ++nodeCounter;
-    GraphNode* newNode = new GraphNode(id, name, type);
-    nodes.push_back(newNode);
+    int id = nodeCounter + 1;
+    insertNode(id, name, type);
     
     std::cout << "\nNode added successfully! ID: " << id << "\n";
     saveToFile();
@@ -72,20 +130,21 @@ void HospitalGraph::addEdge(int fromID, int toID, int distance) {
         return;
     }
     
-    // Check if edge already exists
-    for (auto& neighbor : fromNode->neighbors) {
-        if (neighbor.first->nodeID == toID) {
-            std::cout << "\nEdge already exists! Updating distance.\n";
-            neighbor.second = distance;
-            saveToFile();
-            return;
-        }
+    if (fromNode == toNode) {
+        std::cout << "\nCannot connect a node to itself!\n";
+        return;
     }
     
-    fromNode->neighbors.push_back({toNode, distance});
-    toNode->neighbors.push_back({fromNode, distance}); // Undirected graph
+    if (distance <= 0) {
+        std::cout << "\nDistance must be positive!\n";
+        return;
+    }
     
-    std::cout << "\nEdge added successfully!\n";
+    if (insertEdge(fromNode, toNode, distance)) {
+        std::cout << "\nEdge added successfully!\n";
+    } else {
+        std::cout << "\nEdge already exists! Updating distance.\n";
+    }
     saveToFile();
 }
 
@@ -112,6 +171,13 @@ void HospitalGraph::removeEdge(int fromID, int toID) {
         return;
     }
     
+    if (edgeSet.erase(edgeKey(fromID, toID)) == 0) {
+        std::cout << "\nEdge does not exist!\n";
+        return;
+    }
+    edgeProfiles.erase(edgeKey(fromID, toID));
+    edgeCapacities.erase(edgeKey(fromID, toID));
+    
     // Remove from fromNode's neighbors
     fromNode->neighbors.erase(
         std::remove_if(fromNode->neighbors.begin(), fromNode->neighbors.end(),
@@ -129,6 +195,9 @@ void HospitalGraph::removeEdge(int fromID, int toID) {
             }),
         toNode->neighbors.end()
     );
+    graphVersion++;
+    routeTableValid = false; // Removal can lengthen any route, so rebuild lazily
+    rebuildComponents();     // Union-find cannot split, so relabel from scratch
     
     std::cout << "\nEdge removed successfully!\n";
     saveToFile();
@@ -174,6 +243,10 @@ void HospitalGraph::viewNode(int nodeID) {
         std::cout << "Node ID: " << node->nodeID << "\n";
         std::cout << "Name: " << node->name << "\n";
         std::cout << "Type: " << node->type << "\n";
+        if (node->hasLocation) {
+            std::cout << "Location: " << node->building << ", Floor " << node->floor
+                     << " (" << node->x << ", " << node->y << ")\n";
+        }
         std::cout << "Number of Connections: " << node->neighbors.size() << "\n";
         std::cout << "=====================================\n";
     } else {
@@ -181,6 +254,24 @@ void HospitalGraph::viewNode(int nodeID) {
     }
 }
 
+// Set the location used by A* routing
+void HospitalGraph::setNodeLocation(int nodeID, std::string building, int floor, double x, double y) {
+    GraphNode* node = findNode(nodeID);
+    if (node == nullptr) {
+        std::cout << "\nNode with ID " << nodeID << " not found!\n";
+        return;
+    }
+    
+    node->hasLocation = true;
+    node->building = building;
+    node->floor = floor;
+    node->x = x;
+    node->y = y;
+    
+    std::cout << "\nLocation updated for " << node->name << "!\n";
+    saveToFile();
+}
+
 // View connections for a node
 void HospitalGraph::viewConnections(int nodeID) {
     GraphNode* node = findNode(nodeID);
@@ -202,7 +293,458 @@ void HospitalGraph::viewConnections(int nodeID) {
     std::cout << "==========================================\n";
 }
 
-// Shortest path using BFS (for unweighted) or Dijkstra's (for weighted)
+// Build (or reuse) the CSR snapshot of the current graph
+const GraphCSR& HospitalGraph::snapshot() {
+    if (csrVersion == graphVersion) {
+        return csr;
+    }
+    
+    size_t edgeCount = 0;
+    for (auto node : nodes) {
+        edgeCount += node->neighbors.size();
+    }
+    
+    csr.offsets.assign(1, 0);
+    csr.offsets.reserve(nodes.size() + 1);
+    csr.targets.clear();
+    csr.targets.reserve(edgeCount);
+    csr.weights.clear();
+    csr.weights.reserve(edgeCount);
+    csr.profiles.clear();
+    csr.profiles.reserve(edgeCount);
+    
+    for (auto node : nodes) {
+        for (const auto& neighbor : node->neighbors) {
+            csr.targets.push_back(neighbor.first->index);
+            csr.weights.push_back(neighbor.second);
+            
+            int profile = -1;
+            if (!edgeProfiles.empty()) {
+                auto it = edgeProfiles.find(edgeKey(node->nodeID, neighbor.first->nodeID));
+                if (it != edgeProfiles.end()) profile = it->second;
+            }
+            csr.profiles.push_back(profile);
+        }
+        csr.offsets.push_back(static_cast<int>(csr.targets.size()));
+    }
+    
+    csrVersion = graphVersion;
+    return csr;
+}
+
+// Dijkstra's algorithm over the CSR snapshot (path holds dense indices)
+bool HospitalGraph::dijkstra(int fromIndex, int toIndex, std::vector<int>& path, int& distance) {
+    const GraphCSR& g = snapshot();
+    std::vector<int> dist(nodes.size(), INT_MAX);
+    std::vector<int> parent(nodes.size(), -1);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                        std::greater<std::pair<int, int>>> pq;
+    
+    dist[fromIndex] = 0;
+    pq.push({0, fromIndex});
+    
+    while (!pq.empty()) {
+        std::pair<int, int> top = pq.top();
+        pq.pop();
+        int d = top.first;
+        int u = top.second;
+        
+        if (d > dist[u]) continue;
+        if (u == toIndex) break;
+        
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            int nd = d + g.weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent[v] = u;
+                pq.push({nd, v});
+            }
+        }
+    }
+    
+    if (dist[toIndex] == INT_MAX) {
+        return false;
+    }
+    
+    path.clear();
+    for (int current = toIndex; current != -1; current = parent[current]) {
+        path.push_back(current);
+    }
+    std::reverse(path.begin(), path.end());
+    distance = dist[toIndex];
+    return true;
+}
+
+// Full single-source Dijkstra writing one row of the route tables.
+// next[v] is the first hop on the route from source to v (-1 if unreachable).
+// Only reads the CSR snapshot, so several sources can run in parallel.
+void HospitalGraph::singleSourceRoutes(int source, int* dist, int* next) {
+    const GraphCSR& g = csr;
+    size_t n = nodes.size();
+    std::fill(dist, dist + n, INT_MAX);
+    std::fill(next, next + n, -1);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                        std::greater<std::pair<int, int>>> pq;
+    
+    dist[source] = 0;
+    pq.push({0, source});
+    
+    while (!pq.empty()) {
+        std::pair<int, int> top = pq.top();
+        pq.pop();
+        int d = top.first;
+        int u = top.second;
+        
+        if (d > dist[u]) continue;
+        
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            int nd = d + g.weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                next[v] = (u == source) ? v : next[u];
+                pq.push({nd, v});
+            }
+        }
+    }
+}
+
+// Build the all-pairs tables with one Dijkstra per source, spread over threads
+bool HospitalGraph::ensureRouteTable() {
+    if (routeTableValid) {
+        return true;
+    }
+    size_t n = nodes.size();
+    if (n == 0 || n > ROUTE_TABLE_MAX_NODES) {
+        return false;
+    }
+    
+    snapshot();
+    routeDist.assign(n * n, INT_MAX);
+    routeNext.assign(n * n, -1);
+    
+    size_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+    workerCount = std::min(workerCount, n);
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < workerCount; w++) {
+        workers.emplace_back([this, n, w, workerCount]() {
+            for (size_t source = w; source < n; source += workerCount) {
+                singleSourceRoutes(static_cast<int>(source), &routeDist[source * n], &routeNext[source * n]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    routeTableSize = n;
+    routeTableValid = true;
+    return true;
+}
+
+// Grow the tables by one isolated node after addNode
+void HospitalGraph::extendRouteTable() {
+    if (!routeTableValid) {
+        return;
+    }
+    size_t n = nodes.size();
+    if (n > ROUTE_TABLE_MAX_NODES || n != routeTableSize + 1) {
+        routeTableValid = false;
+        return;
+    }
+    
+    std::vector<int> dist(n * n, INT_MAX);
+    std::vector<int> next(n * n, -1);
+    for (size_t i = 0; i < routeTableSize; i++) {
+        std::copy(&routeDist[i * routeTableSize], &routeDist[i * routeTableSize] + routeTableSize, &dist[i * n]);
+        std::copy(&routeNext[i * routeTableSize], &routeNext[i * routeTableSize] + routeTableSize, &next[i * n]);
+    }
+    dist[n * n - 1] = 0;
+    
+    routeDist.swap(dist);
+    routeNext.swap(next);
+    routeTableSize = n;
+}
+
+// Repair the tables after edge (u, v) was added or shortened to 'weight':
+// any route can only improve by passing through the new edge, in O(V^2)
+void HospitalGraph::relaxRouteTable(int u, int v, int weight) {
+    if (!routeTableValid) {
+        return;
+    }
+    size_t n = routeTableSize;
+    
+    for (int pass = 0; pass < 2; pass++) {
+        int a = pass == 0 ? u : v; // Route i -> a -> b -> j
+        int b = pass == 0 ? v : u;
+        for (size_t i = 0; i < n; i++) {
+            int toA = routeDist[i * n + a];
+            if (toA == INT_MAX) continue;
+            int hop = (static_cast<int>(i) == a) ? b : routeNext[i * n + a];
+            
+            for (size_t j = 0; j < n; j++) {
+                int fromB = routeDist[b * n + j];
+                if (fromB == INT_MAX) continue;
+                int candidate = toA + weight + fromB;
+                if (candidate < routeDist[i * n + j]) {
+                    routeDist[i * n + j] = candidate;
+                    routeNext[i * n + j] = hop;
+                }
+            }
+        }
+    }
+}
+
+// Route lookup from the tables in O(path length)
+bool HospitalGraph::lookupRoute(int fromIndex, int toIndex, std::vector<int>& path, int& distance) {
+    size_t n = routeTableSize;
+    distance = routeDist[fromIndex * n + toIndex];
+    if (distance == INT_MAX) {
+        return false;
+    }
+    
+    path.clear();
+    path.push_back(fromIndex);
+    for (int current = fromIndex; current != toIndex; ) {
+        current = routeNext[current * n + toIndex];
+        path.push_back(current);
+    }
+    return true;
+}
+
+// A* heuristic: straight-line distance plus the minimum cost of the floor
+// changes. Admissible as long as corridor distances are at least the
+// straight-line distance and every node has a location; astar() drops it
+// otherwise, since a path through unlocated nodes has no such lower bound.
+double HospitalGraph::heuristic(int fromIndex, int toIndex) {
+    const GraphNode* a = nodes[fromIndex];
+    const GraphNode* b = nodes[toIndex];
+    if (!a->hasLocation || !b->hasLocation) {
+        return 0.0;
+    }
+    double dx = a->x - b->x;
+    double dy = a->y - b->y;
+    return std::sqrt(dx * dx + dy * dy) + FLOOR_CHANGE_COST * std::abs(a->floor - b->floor);
+}
+
+// A* search over the CSR snapshot; explored counts node expansions. Open
+// entries carry the cost they were pushed with, so an entry is stale once
+// dist[] has improved and a node whose cost improves is expanded again.
+// Unless every node has a location the search runs with h = 0 (Dijkstra).
+bool HospitalGraph::astar(int fromIndex, int toIndex, std::vector<int>& path, int& distance, int& explored) {
+    typedef std::pair<double, std::pair<int, int>> OpenEntry; // (f, (g, node))
+    const GraphCSR& g = snapshot();
+    bool useHeuristic = true;
+    for (size_t i = 0; i < nodes.size() && useHeuristic; i++) {
+        useHeuristic = nodes[i]->hasLocation;
+    }
+    std::vector<int> dist(nodes.size(), INT_MAX);
+    std::vector<int> parent(nodes.size(), -1);
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+    
+    dist[fromIndex] = 0;
+    open.push({useHeuristic ? heuristic(fromIndex, toIndex) : 0.0, {0, fromIndex}});
+    explored = 0;
+    
+    while (!open.empty()) {
+        int cost = open.top().second.first;
+        int u = open.top().second.second;
+        open.pop();
+        
+        if (cost > dist[u]) continue;
+        explored++;
+        if (u == toIndex) break;
+        
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            int nd = dist[u] + g.weights[e];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent[v] = u;
+                open.push({nd + (useHeuristic ? heuristic(v, toIndex) : 0.0), {nd, v}});
+            }
+        }
+    }
+    
+    if (dist[toIndex] == INT_MAX) {
+        return false;
+    }
+    
+    path.clear();
+    for (int current = toIndex; current != -1; current = parent[current]) {
+        path.push_back(current);
+    }
+    std::reverse(path.begin(), path.end());
+    distance = dist[toIndex];
+    return true;
+}
+
+// Route query through the LRU cache, falling back to the route table or Dijkstra
+bool HospitalGraph::findRoute(int fromIndex, int toIndex, std::vector<int>& path, int& distance) {
+    if (routeCacheVersion != graphVersion) {
+        if (!routeCache.empty()) {
+            routeCacheInvalidations++;
+        }
+        routeCache.clear();
+        routeCacheIndex.clear();
+        routeCacheVersion = graphVersion;
+    }
+    
+    long long key = (static_cast<long long>(fromIndex) << 32) | static_cast<unsigned int>(toIndex);
+    auto cached = routeCacheIndex.find(key);
+    if (cached != routeCacheIndex.end()) {
+        routeCacheHits++;
+        routeCache.splice(routeCache.begin(), routeCache, cached->second);
+        path = cached->second->path;
+        distance = cached->second->distance;
+        return cached->second->found;
+    }
+    routeCacheMisses++;
+    
+    bool found = ensureRouteTable()
+        ? lookupRoute(fromIndex, toIndex, path, distance)
+        : dijkstra(fromIndex, toIndex, path, distance);
+    
+    if (routeCacheCapacity > 0) {
+        if (routeCache.size() >= routeCacheCapacity) {
+            routeCacheIndex.erase(routeCache.back().key);
+            routeCache.pop_back();
+            routeCacheEvictions++;
+        }
+        routeCache.push_front({key, found, found ? distance : 0, found ? path : std::vector<int>()});
+        routeCacheIndex[key] = routeCache.begin();
+    }
+    return found;
+}
+
+// Resize the route cache, evicting least recently used routes if needed
+void HospitalGraph::setRouteCacheCapacity(size_t capacity) {
+    routeCacheCapacity = capacity;
+    while (routeCache.size() > routeCacheCapacity) {
+        routeCacheIndex.erase(routeCache.back().key);
+        routeCache.pop_back();
+        routeCacheEvictions++;
+    }
+    std::cout << "\nRoute cache capacity set to " << routeCacheCapacity << "\n";
+}
+
+// Hit/miss/eviction counters for sizing the cache
+void HospitalGraph::viewRouteCacheStats() {
+    unsigned long lookups = routeCacheHits + routeCacheMisses;
+    std::cout << "\n========== ROUTE CACHE ==========\n";
+    std::cout << "Capacity: " << routeCacheCapacity << "\n";
+    std::cout << "Cached Routes: " << routeCache.size() << "\n";
+    std::cout << "Hits: " << routeCacheHits << "\n";
+    std::cout << "Misses: " << routeCacheMisses << "\n";
+    std::cout << "Hit Rate: " << (lookups == 0 ? 0.0 : 100.0 * routeCacheHits / lookups) << "%\n";
+    std::cout << "Evictions: " << routeCacheEvictions << "\n";
+    std::cout << "Invalidations (graph changed): " << routeCacheInvalidations << "\n";
+    std::cout << "=====================================\n";
+}
+
+// Distance of an edge when entered at the given minute of the day
+int HospitalGraph::weightAt(int distance, int profile, int minuteOfDay) {
+    if (profile < 0) {
+        return distance;
+    }
+    
+    // Last breakpoint starting at or before this minute (wrapping to the previous day)
+    int first = profileOffsets[profile];
+    int last = profileOffsets[profile + 1];
+    int active = last - 1;
+    for (int i = first; i < last && profileStartMinutes[i] <= minuteOfDay; i++) {
+        active = i;
+    }
+    return distance * profilePercents[active] / 100;
+}
+
+// Minutes from reaching an edge at the given minute of the day to arriving
+// at its far end, waiting first if a cheaper period starts soon enough. The
+// weight is constant between breakpoints, so the only departures worth
+// considering are now and the next start of each breakpoint.
+int HospitalGraph::edgeDelay(int distance, int profile, int minuteOfDay) {
+    int best = weightAt(distance, profile, minuteOfDay);
+    if (profile < 0) {
+        return best;
+    }
+    
+    for (int i = profileOffsets[profile]; i < profileOffsets[profile + 1]; i++) {
+        int wait = (profileStartMinutes[i] - minuteOfDay + 1440) % 1440;
+        if (wait > 0 && wait < best) {
+            best = std::min(best, wait + distance * profilePercents[i] / 100);
+        }
+    }
+    return best;
+}
+
+// Time-dependent Dijkstra: labels are elapsed minutes since departure. Each
+// edge costs its delay at the time it is reached, including any wait for a
+// cheaper period, so arriving later never leaves later (FIFO) even when a
+// profile steps down, and the labels are exact.
+bool HospitalGraph::timeDependentDijkstra(int fromIndex, int toIndex, int departureMinute,
+                                          std::vector<int>& path, int& travelTime) {
+    const GraphCSR& g = snapshot();
+    std::vector<int> arrival(nodes.size(), INT_MAX);
+    std::vector<int> parent(nodes.size(), -1);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                        std::greater<std::pair<int, int>>> pq;
+    
+    arrival[fromIndex] = 0;
+    pq.push({0, fromIndex});
+    
+    while (!pq.empty()) {
+        std::pair<int, int> top = pq.top();
+        pq.pop();
+        int t = top.first;
+        int u = top.second;
+        
+        if (t > arrival[u]) continue;
+        if (u == toIndex) break;
+        
+        int minuteOfDay = (departureMinute + t) % 1440;
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            int nt = t + edgeDelay(g.weights[e], g.profiles[e], minuteOfDay);
+            if (nt < arrival[v]) {
+                arrival[v] = nt;
+                parent[v] = u;
+                pq.push({nt, v});
+            }
+        }
+    }
+    
+    if (arrival[toIndex] == INT_MAX) {
+        return false;
+    }
+    
+    path.clear();
+    for (int current = toIndex; current != -1; current = parent[current]) {
+        path.push_back(current);
+    }
+    std::reverse(path.begin(), path.end());
+    travelTime = arrival[toIndex];
+    return true;
+}
+
+// Print a route given as dense node indices
+void HospitalGraph::printPath(const std::vector<int>& path, int distance) {
+    std::cout << "\n========== SHORTEST PATH ==========\n";
+    std::cout << "From: " << nodes[path.front()]->name << "\n";
+    std::cout << "To: " << nodes[path.back()]->name << "\n";
+    std::cout << "Distance: " << distance << " units\n";
+    std::cout << "Path: ";
+    
+    for (size_t i = 0; i < path.size(); i++) {
+        std::cout << nodes[path[i]]->name;
+        if (i < path.size() - 1) {
+            std::cout << " -> ";
+        }
+    }
+    std::cout << "\n=====================================\n";
+}
+
+// Shortest path using Dijkstra's algorithm
 void HospitalGraph::shortestPath(int fromID, int toID) {
     GraphNode* fromNode = findNode(fromID);
     GraphNode* toNode = findNode(toID);
@@ -217,63 +759,454 @@ void HospitalGraph::shortestPath(int fromID, int toID) {
         return;
     }
     
-    // Using BFS for unweighted graph (simple implementation)
-    std::queue<GraphNode*> q;
-    std::vector<bool> visited(nodes.size() + 1, false);
-    std::vector<int> parent(nodes.size() + 1, -1);
-    std::vector<int> distance(nodes.size() + 1, INT_MAX);
+    std::vector<int> path;
+    int distance;
+    if (!findRoute(fromNode->index, toNode->index, path, distance)) {
+        std::cout << "\nNo path found between " << fromNode->name 
+                 << " and " << toNode->name << "!\n";
+        return;
+    }
     
-    q.push(fromNode);
-    visited[fromNode->nodeID] = true;
-    distance[fromNode->nodeID] = 0;
+    printPath(path, distance);
+}
+
+// Shortest path using A* guided by node locations
+void HospitalGraph::astarPath(int fromID, int toID) {
+    GraphNode* fromNode = findNode(fromID);
+    GraphNode* toNode = findNode(toID);
     
-    while (!q.empty()) {
-        GraphNode* current = q.front();
-        q.pop();
-        
-        if (current->nodeID == toID) {
-            break;
+    if (fromNode == nullptr || toNode == nullptr) {
+        std::cout << "\nInvalid node IDs!\n";
+        return;
+    }
+    
+    std::vector<int> path;
+    int distance, explored;
+    if (!astar(fromNode->index, toNode->index, path, distance, explored)) {
+        std::cout << "\nNo path found between " << fromNode->name 
+                 << " and " << toNode->name << "!\n";
+        return;
+    }
+    
+    printPath(path, distance);
+    std::cout << "Nodes explored: " << explored << " of " << nodes.size() << "\n";
+}
+
+// Multi-source Dijkstra from every node of the given type, cached until the graph changes
+const FacilityAssignment& HospitalGraph::facilityAssignment(const std::string& type) {
+    FacilityAssignment& result = facilityCache[type];
+    if (result.version == graphVersion && result.facility.size() == nodes.size()) {
+        return result;
+    }
+    
+    const GraphCSR& g = snapshot();
+    size_t n = nodes.size();
+    result.facility.assign(n, -1);
+    result.distance.assign(n, INT_MAX);
+    result.nextHop.assign(n, -1);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                        std::greater<std::pair<int, int>>> pq;
+    
+    for (size_t i = 0; i < n; i++) {
+        if (nodes[i]->type == type) {
+            result.facility[i] = static_cast<int>(i);
+            result.distance[i] = 0;
+            pq.push({0, static_cast<int>(i)});
         }
+    }
+    
+    while (!pq.empty()) {
+        std::pair<int, int> top = pq.top();
+        pq.pop();
+        int d = top.first;
+        int u = top.second;
+        
+        if (d > result.distance[u]) continue;
         
-        for (const auto& neighbor : current->neighbors) {
-            if (!visited[neighbor.first->nodeID]) {
-                visited[neighbor.first->nodeID] = true;
-                distance[neighbor.first->nodeID] = distance[current->nodeID] + neighbor.second;
-                parent[neighbor.first->nodeID] = current->nodeID;
-                q.push(neighbor.first);
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            int nd = d + g.weights[e];
+            if (nd < result.distance[v]) {
+                result.distance[v] = nd;
+                result.facility[v] = result.facility[u];
+                result.nextHop[v] = u;
+                pq.push({nd, v});
             }
         }
     }
     
-    if (distance[toID] == INT_MAX) {
-        std::cout << "\nNo path found between " << fromNode->name 
-                 << " and " << toNode->name << "!\n";
+    result.version = graphVersion;
+    return result;
+}
+
+// Nearest node of a type (e.g. Pharmacy, ICU, Emergency) from a location
+void HospitalGraph::nearestFacility(int fromID, const std::string& type) {
+    GraphNode* fromNode = findNode(fromID);
+    if (fromNode == nullptr) {
+        std::cout << "\nNode with ID " << fromID << " not found!\n";
+        return;
+    }
+    
+    const FacilityAssignment& assignment = facilityAssignment(type);
+    int facility = assignment.facility[fromNode->index];
+    if (facility == -1) {
+        std::cout << "\nNo reachable node of type '" << type << "' from " << fromNode->name << "!\n";
         return;
     }
     
-    // Reconstruct path
     std::vector<int> path;
-    int current = toID;
-    while (current != -1) {
+    for (int current = fromNode->index; current != -1; current = assignment.nextHop[current]) {
         path.push_back(current);
-        current = parent[current];
     }
-    std::reverse(path.begin(), path.end());
     
-    std::cout << "\n========== SHORTEST PATH ==========\n";
-    std::cout << "From: " << fromNode->name << "\n";
-    std::cout << "To: " << toNode->name << "\n";
-    std::cout << "Distance: " << distance[toID] << " units\n";
-    std::cout << "Path: ";
+    std::cout << "\nNearest " << type << ": " << nodes[facility]->name
+             << " (ID: " << nodes[facility]->nodeID << ")\n";
+    printPath(path, assignment.distance[fromNode->index]);
+}
+
+// Assignment of every node to its nearest facility of a type
+void HospitalGraph::viewFacilityCoverage(const std::string& type) {
+    clearScreen();
+    std::cout << "========== NEAREST " << type << " FOR EACH LOCATION ==========\n\n";
     
-    for (size_t i = 0; i < path.size(); i++) {
-        GraphNode* node = findNode(path[i]);
-        std::cout << node->name;
-        if (i < path.size() - 1) {
-            std::cout << " -> ";
+    const FacilityAssignment& assignment = facilityAssignment(type);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        std::cout << nodes[i]->name << " -> ";
+        if (assignment.facility[i] == -1) {
+            std::cout << "unreachable\n";
+        } else {
+            std::cout << nodes[assignment.facility[i]]->name
+                     << " (Distance: " << assignment.distance[i] << ")\n";
         }
     }
-    std::cout << "\n=====================================\n";
+    
+    std::cout << "\n==========================================\n";
+}
+
+// Add a weight profile; breakpoints are (start minute of day, percent of base distance)
+int HospitalGraph::addWeightProfile(std::string name, const std::vector<std::pair<int, int>>& breakpoints) {
+    std::vector<std::pair<int, int>> sorted(breakpoints);
+    std::sort(sorted.begin(), sorted.end());
+    
+    if (sorted.empty() || sorted.front().first < 0 || sorted.back().first >= 1440) {
+        std::cout << "\nInvalid profile: start times must be within the day!\n";
+        return -1;
+    }
+    for (const auto& breakpoint : sorted) {
+        if (breakpoint.second <= 0 || breakpoint.second > 65535) {
+            std::cout << "\nInvalid profile: percentages must be positive!\n";
+            return -1;
+        }
+    }
+    
+    for (const auto& breakpoint : sorted) {
+        profileStartMinutes.push_back(static_cast<unsigned short>(breakpoint.first));
+        profilePercents.push_back(static_cast<unsigned short>(breakpoint.second));
+    }
+    profileOffsets.push_back(static_cast<int>(profileStartMinutes.size()));
+    profileNames.push_back(name);
+    
+    int id = static_cast<int>(profileNames.size()) - 1;
+    saveToFile();
+    return id;
+}
+
+// Attach a profile to an edge (-1 makes the edge static again)
+void HospitalGraph::setEdgeProfile(int fromID, int toID, int profileID) {
+    if (edgeSet.find(edgeKey(fromID, toID)) == edgeSet.end()) {
+        std::cout << "\nEdge does not exist!\n";
+        return;
+    }
+    if (profileID >= static_cast<int>(profileNames.size())) {
+        std::cout << "\nProfile with ID " << profileID << " not found!\n";
+        return;
+    }
+    
+    if (profileID < 0) {
+        edgeProfiles.erase(edgeKey(fromID, toID));
+    } else {
+        edgeProfiles[edgeKey(fromID, toID)] = profileID;
+    }
+    graphVersion++;
+    
+    std::cout << "\nEdge profile updated!\n";
+    saveToFile();
+}
+
+// List weight profiles
+void HospitalGraph::viewWeightProfiles() {
+    std::cout << "\n========== WEIGHT PROFILES ==========\n";
+    if (profileNames.empty()) {
+        std::cout << "No profiles defined.\n";
+    }
+    for (size_t p = 0; p < profileNames.size(); p++) {
+        std::cout << p << ". " << profileNames[p] << ":";
+        for (int i = profileOffsets[p]; i < profileOffsets[p + 1]; i++) {
+            std::cout << " " << std::setfill('0') << std::setw(2) << profileStartMinutes[i] / 60
+                     << ":" << std::setw(2) << profileStartMinutes[i] % 60 << std::setfill(' ')
+                     << "=" << profilePercents[i] << "%";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "Edges with profiles: " << edgeProfiles.size() << "\n";
+    std::cout << "=====================================\n";
+}
+
+// Fastest route when leaving at a given minute of the day
+void HospitalGraph::timeDependentPath(int fromID, int toID, int departureMinute) {
+    GraphNode* fromNode = findNode(fromID);
+    GraphNode* toNode = findNode(toID);
+    
+    if (fromNode == nullptr || toNode == nullptr) {
+        std::cout << "\nInvalid node IDs!\n";
+        return;
+    }
+    
+    departureMinute = ((departureMinute % 1440) + 1440) % 1440;
+    
+    std::vector<int> path;
+    int travelTime;
+    if (!timeDependentDijkstra(fromNode->index, toNode->index, departureMinute, path, travelTime)) {
+        std::cout << "\nNo path found between " << fromNode->name 
+                 << " and " << toNode->name << "!\n";
+        return;
+    }
+    
+    printPath(path, travelTime);
+    int arrival = (departureMinute + travelTime) % 1440;
+    std::cout << "Arrival time: " << std::setfill('0') << std::setw(2) << arrival / 60
+             << ":" << std::setw(2) << arrival % 60 << std::setfill(' ') << "\n";
+}
+
+// Capacity of a corridor in people per minute
+int HospitalGraph::edgeCapacity(int fromID, int toID) {
+    auto it = edgeCapacities.find(edgeKey(fromID, toID));
+    return it != edgeCapacities.end() ? it->second : DEFAULT_EDGE_CAPACITY;
+}
+
+// Dinic max-flow from a set of source nodes to a set of sink nodes (dense
+// indices), joined through a super source and super sink. Every corridor
+// becomes a pair of opposite arcs sharing its capacity, so arc a's reverse
+// is a ^ 1. Returns the total flow, the flow reaching each sink and the
+// saturated corridors of the minimum cut.
+long long HospitalGraph::maxFlow(const std::vector<int>& sources, const std::vector<int>& sinks,
+                                 std::vector<long long>& sinkFlow,
+                                 std::vector<std::pair<int, int>>& cutEdges) {
+    const GraphCSR& g = snapshot();
+    int n = static_cast<int>(nodes.size());
+    int superSource = n;
+    int superSink = n + 1;
+    const long long unlimited = LLONG_MAX / 4;
+    
+    std::vector<int> arcTo;
+    std::vector<long long> arcCap;
+    std::vector<int> arcFrom;
+    arcTo.reserve(g.targets.size() + 2 * (sources.size() + sinks.size()));
+    arcCap.reserve(arcTo.capacity());
+    arcFrom.reserve(arcTo.capacity());
+    
+    auto addArcPair = [&](int u, int v, long long forward, long long backward) {
+        arcFrom.push_back(u); arcTo.push_back(v); arcCap.push_back(forward);
+        arcFrom.push_back(v); arcTo.push_back(u); arcCap.push_back(backward);
+    };
+    
+    for (int u = 0; u < n; u++) {
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            if (u < v) {
+                long long capacity = edgeCapacity(nodes[u]->nodeID, nodes[v]->nodeID);
+                addArcPair(u, v, capacity, capacity);
+            }
+        }
+    }
+    size_t corridorArcs = arcTo.size();
+    for (int source : sources) addArcPair(superSource, source, unlimited, 0);
+    size_t sinkArcs = arcTo.size();
+    for (int sink : sinks) addArcPair(sink, superSink, unlimited, 0);
+    
+    // Arc indices grouped by tail node
+    int total = n + 2;
+    std::vector<int> arcOffsets(total + 1, 0);
+    for (int from : arcFrom) arcOffsets[from + 1]++;
+    for (int i = 0; i < total; i++) arcOffsets[i + 1] += arcOffsets[i];
+    std::vector<int> arcsByNode(arcFrom.size());
+    {
+        std::vector<int> fill(arcOffsets.begin(), arcOffsets.end() - 1);
+        for (size_t a = 0; a < arcFrom.size(); a++) {
+            arcsByNode[fill[arcFrom[a]]++] = static_cast<int>(a);
+        }
+    }
+    
+    std::vector<int> level(total);
+    std::vector<int> nextArc(total);
+    std::vector<int> pathArcs;
+    std::queue<int> q;
+    long long flow = 0;
+    
+    while (true) {
+        // Level graph by BFS over residual arcs
+        std::fill(level.begin(), level.end(), -1);
+        level[superSource] = 0;
+        q.push(superSource);
+        while (!q.empty()) {
+            int u = q.front();
+            q.pop();
+            for (int i = arcOffsets[u]; i < arcOffsets[u + 1]; i++) {
+                int a = arcsByNode[i];
+                if (arcCap[a] > 0 && level[arcTo[a]] < 0) {
+                    level[arcTo[a]] = level[u] + 1;
+                    q.push(arcTo[a]);
+                }
+            }
+        }
+        if (level[superSink] < 0) break;
+        
+        // Blocking flow with an explicit path stack (no recursion on long corridors)
+        for (int i = 0; i < total; i++) nextArc[i] = arcOffsets[i];
+        pathArcs.clear();
+        int u = superSource;
+        while (true) {
+            if (u == superSink) {
+                long long bottleneck = unlimited;
+                for (int a : pathArcs) bottleneck = std::min(bottleneck, arcCap[a]);
+                size_t retreat = pathArcs.size();
+                for (size_t i = 0; i < pathArcs.size(); i++) {
+                    int a = pathArcs[i];
+                    arcCap[a] -= bottleneck;
+                    arcCap[a ^ 1] += bottleneck;
+                    if (arcCap[a] == 0 && retreat == pathArcs.size()) retreat = i;
+                }
+                flow += bottleneck;
+                pathArcs.resize(retreat);
+                u = pathArcs.empty() ? superSource : arcTo[pathArcs.back()];
+                continue;
+            }
+            
+            bool advanced = false;
+            for (; nextArc[u] < arcOffsets[u + 1]; nextArc[u]++) {
+                int a = arcsByNode[nextArc[u]];
+                if (arcCap[a] > 0 && level[arcTo[a]] == level[u] + 1) {
+                    pathArcs.push_back(a);
+                    u = arcTo[a];
+                    advanced = true;
+                    break;
+                }
+            }
+            if (advanced) continue;
+            
+            // Dead end: prune the node and step back
+            level[u] = -1;
+            if (u == superSource) break;
+            u = arcFrom[pathArcs.back()];
+            pathArcs.pop_back();
+            nextArc[u]++;
+        }
+    }
+    
+    // Flow into each sink is what its super-sink arc carried
+    sinkFlow.assign(sinks.size(), 0);
+    for (size_t i = 0; i < sinks.size(); i++) {
+        sinkFlow[i] = arcCap[sinkArcs + 2 * i + 1];
+    }
+    
+    // Min cut: corridors leaving the set still reachable in the residual graph
+    std::vector<bool> reachable(total, false);
+    reachable[superSource] = true;
+    q.push(superSource);
+    while (!q.empty()) {
+        int v = q.front();
+        q.pop();
+        for (int i = arcOffsets[v]; i < arcOffsets[v + 1]; i++) {
+            int a = arcsByNode[i];
+            if (arcCap[a] > 0 && !reachable[arcTo[a]]) {
+                reachable[arcTo[a]] = true;
+                q.push(arcTo[a]);
+            }
+        }
+    }
+    cutEdges.clear();
+    for (size_t a = 0; a < corridorArcs; a += 2) {
+        if (reachable[arcFrom[a]] != reachable[arcTo[a]]) {
+            cutEdges.push_back({arcFrom[a], arcTo[a]});
+        }
+    }
+    return flow;
+}
+
+// Set the capacity of a corridor (people per minute)
+void HospitalGraph::setEdgeCapacity(int fromID, int toID, int capacity) {
+    if (edgeSet.find(edgeKey(fromID, toID)) == edgeSet.end()) {
+        std::cout << "\nEdge does not exist!\n";
+        return;
+    }
+    if (capacity < 0) {
+        std::cout << "\nCapacity cannot be negative!\n";
+        return;
+    }
+    
+    edgeCapacities[edgeKey(fromID, toID)] = capacity;
+    std::cout << "\nCorridor capacity updated!\n";
+    saveToFile();
+}
+
+// Maximum evacuation rate from wards to exits and the corridors that limit it
+void HospitalGraph::evacuationAnalysis(const std::vector<int>& wardIDs, const std::vector<int>& exitIDs) {
+    std::vector<int> sources, sinks;
+    std::vector<bool> isSource(nodes.size(), false);
+    
+    for (int id : wardIDs) {
+        GraphNode* node = findNode(id);
+        if (node == nullptr) {
+            std::cout << "\nNode with ID " << id << " not found!\n";
+            return;
+        }
+        if (!isSource[node->index]) {
+            isSource[node->index] = true;
+            sources.push_back(node->index);
+        }
+    }
+    for (int id : exitIDs) {
+        GraphNode* node = findNode(id);
+        if (node == nullptr) {
+            std::cout << "\nNode with ID " << id << " not found!\n";
+            return;
+        }
+        if (isSource[node->index]) {
+            std::cout << "\n" << node->name << " cannot be both a ward and an exit!\n";
+            return;
+        }
+        if (std::find(sinks.begin(), sinks.end(), node->index) == sinks.end()) {
+            sinks.push_back(node->index);
+        }
+    }
+    if (sources.empty() || sinks.empty()) {
+        std::cout << "\nAt least one ward and one exit are required!\n";
+        return;
+    }
+    
+    std::vector<long long> sinkFlow;
+    std::vector<std::pair<int, int>> cutEdges;
+    long long flow = maxFlow(sources, sinks, sinkFlow, cutEdges);
+    
+    std::cout << "\n========== EVACUATION ANALYSIS ==========\n";
+    std::cout << "Maximum evacuation rate: " << flow << " people/minute\n";
+    
+    std::cout << "\nFlow per exit:\n";
+    for (size_t i = 0; i < sinks.size(); i++) {
+        std::cout << "  " << nodes[sinks[i]]->name << ": " << sinkFlow[i] << " people/minute\n";
+    }
+    
+    std::cout << "\nBottleneck corridors (minimum cut):\n";
+    if (cutEdges.empty()) {
+        std::cout << "  None - no route from the wards to any exit.\n";
+    }
+    for (const auto& edge : cutEdges) {
+        GraphNode* a = nodes[edge.first];
+        GraphNode* b = nodes[edge.second];
+        std::cout << "  " << a->name << " <-> " << b->name << " (capacity "
+                 << edgeCapacity(a->nodeID, b->nodeID) << ")\n";
+    }
+    std::cout << "=========================================\n";
 }
 
 // Department connections
@@ -292,33 +1225,116 @@ void HospitalGraph::departmentConnections() {
     pause();
 }
 
-// DFS Helper
-void HospitalGraph::DFSHelper(GraphNode* node, std::vector<bool>& visited) {
-    visited[node->nodeID] = true;
-    for (const auto& neighbor : node->neighbors) {
-        if (!visited[neighbor.first->nodeID]) {
-            DFSHelper(neighbor.first, visited);
+// DFS Helper (iterative over the CSR snapshot, collects dense indices)
+void HospitalGraph::DFSHelper(int start, std::vector<bool>& visited, std::vector<int>& component) {
+    const GraphCSR& g = snapshot();
+    std::vector<int> stack;
+    stack.push_back(start);
+    visited[start] = true;
+    
+    while (!stack.empty()) {
+        int u = stack.back();
+        stack.pop_back();
+        component.push_back(u);
+        
+        for (int e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            int v = g.targets[e];
+            if (!visited[v]) {
+                visited[v] = true;
+                stack.push_back(v);
+            }
         }
     }
 }
 
-// Find connected components
-void HospitalGraph::findConnectedComponents() {
-    std::vector<bool> visited(nodes.size() + 1, false);
-    int componentCount = 0;
+// Find the component representative (iterative, with path halving)
+int HospitalGraph::findComponent(int index) {
+    while (componentParent[index] != index) {
+        componentParent[index] = componentParent[componentParent[index]];
+        index = componentParent[index];
+    }
+    return index;
+}
+
+// Merge two components (union by rank)
+void HospitalGraph::uniteComponents(int a, int b) {
+    int rootA = findComponent(a);
+    int rootB = findComponent(b);
+    if (rootA == rootB) {
+        return;
+    }
     
-    for (auto node : nodes) {
-        if (!visited[node->nodeID]) {
-            componentCount++;
-            std::cout << "\nComponent " << componentCount << ":\n";
-            DFSHelper(node, visited);
-            
-            // Print nodes in this component
-            for (auto n : nodes) {
-                if (visited[n->nodeID]) {
-                    std::cout << "  - " << n->name << "\n";
-                }
+    if (componentRank[rootA] < componentRank[rootB]) {
+        std::swap(rootA, rootB);
+    }
+    componentParent[rootB] = rootA;
+    if (componentRank[rootA] == componentRank[rootB]) {
+        componentRank[rootA]++;
+    }
+    componentCount--;
+}
+
+// Relabel every component with one DFS pass after an edge removal
+void HospitalGraph::rebuildComponents() {
+    std::vector<bool> visited(nodes.size(), false);
+    componentParent.assign(nodes.size(), 0);
+    componentRank.assign(nodes.size(), 0);
+    componentCount = 0;
+    
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (!visited[i]) {
+            std::vector<int> component;
+            DFSHelper(static_cast<int>(i), visited, component);
+            for (int index : component) {
+                componentParent[index] = static_cast<int>(i);
             }
+            componentRank[i] = component.size() > 1 ? 1 : 0;
+            componentCount++;
+        }
+    }
+}
+
+// Check whether two locations are connected
+bool HospitalGraph::areConnected(int fromID, int toID) {
+    GraphNode* fromNode = findNode(fromID);
+    GraphNode* toNode = findNode(toID);
+    if (fromNode == nullptr || toNode == nullptr) {
+        return false;
+    }
+    return findComponent(fromNode->index) == findComponent(toNode->index);
+}
+
+void HospitalGraph::checkConnectivity(int fromID, int toID) {
+    GraphNode* fromNode = findNode(fromID);
+    GraphNode* toNode = findNode(toID);
+    
+    if (fromNode == nullptr || toNode == nullptr) {
+        std::cout << "\nInvalid node IDs!\n";
+        return;
+    }
+    
+    std::cout << "\n" << fromNode->name << " and " << toNode->name
+             << (areConnected(fromID, toID) ? " are connected.\n" : " are NOT connected.\n");
+}
+
+// Find connected components (grouped by union-find representative)
+void HospitalGraph::findConnectedComponents() {
+    std::vector<int> label(nodes.size(), -1);
+    std::vector<std::vector<int>> components;
+    
+    for (size_t i = 0; i < nodes.size(); i++) {
+        int root = findComponent(static_cast<int>(i));
+        if (label[root] == -1) {
+            label[root] = static_cast<int>(components.size());
+            components.push_back({});
+        }
+        components[label[root]].push_back(static_cast<int>(i));
+    }
+    
+    for (size_t c = 0; c < components.size(); c++) {
+        std::cout << "\nComponent " << (c + 1) << ":\n";
+        for (int index : components[c]) {
+            std::cout << "  - " << nodes[index]->name << "\n";
         }
     }
     
@@ -349,7 +1365,20 @@ void HospitalGraph::initializeSampleData() {
 
 // Load graph from file
 void HospitalGraph::loadFromFile() {
-    std::ifstream file("hospitalGraph.txt");
+    if (persistent) {
+        readFromFile("hospitalGraph.txt");
+    }
+}
+
+// Save graph to file
+void HospitalGraph::saveToFile() {
+    if (persistent) {
+        writeToFile("hospitalGraph.txt");
+    }
+}
+
+void HospitalGraph::readFromFile(const std::string& filename) {
+    std::ifstream file(filename);
     if (!file.is_open()) {
         return;
     }
@@ -370,62 +1399,142 @@ void HospitalGraph::loadFromFile() {
             
             if (!name.empty() && name[0] == ' ') name = name.substr(1);
             
-            GraphNode* newNode = new GraphNode(id, name, type);
-            nodes.push_back(newNode);
+            GraphNode* newNode = insertNode(id, name, type);
             
-            if (id > nodeCounter) {
-                nodeCounter = id;
+            // Optional location: "|building|floor x y|"
+            std::string building;
+            if (std::getline(iss, building, '|')) {
+                int floor;
+                double x, y;
+                if (iss >> floor >> x >> y) {
+                    newNode->hasLocation = true;
+                    newNode->building = building;
+                    newNode->floor = floor;
+                    newNode->x = x;
+                    newNode->y = y;
+                }
             }
         }
     }
     
-    // Load edges
-    while (std::getline(file, line)) {
+    // Load edges ("from to distance [profile [capacity]]")
+    while (std::getline(file, line) && line != "PROFILES:") {
         if (line.empty()) continue;
         
         std::istringstream iss(line);
         int fromID, toID, distance;
         
         if (iss >> fromID >> toID >> distance) {
-            addEdge(fromID, toID, distance);
+            GraphNode* fromNode = findNode(fromID);
+            GraphNode* toNode = findNode(toID);
+            if (fromNode != nullptr && toNode != nullptr && fromNode != toNode && distance > 0) {
+                insertEdge(fromNode, toNode, distance);
+                
+                int profile, capacity;
+                if (iss >> profile && profile >= 0) {
+                    edgeProfiles[edgeKey(fromID, toID)] = profile;
+                }
+                if (iss >> capacity && capacity >= 0) {
+                    edgeCapacities[edgeKey(fromID, toID)] = capacity;
+                }
+            }
         }
     }
     
+    // Load weight profiles ("id |name|start percent;start percent|")
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        
+        std::istringstream iss(line);
+        int id;
+        std::string name, breakpoints;
+        
+        if (iss >> id) {
+            std::getline(iss, name, '|');
+            std::getline(iss, name, '|');
+            std::getline(iss, breakpoints, '|');
+            
+            // Same rules as addWeightProfile(); out-of-range breakpoints are
+            // dropped and a profile left empty keeps its ID as a flat 100%
+            std::vector<std::pair<int, int>> sorted;
+            std::istringstream bIss(breakpoints);
+            std::string entry;
+            while (std::getline(bIss, entry, ';')) {
+                std::istringstream eIss(entry);
+                int start, percent;
+                if (eIss >> start >> percent && start >= 0 && start < 1440 &&
+                    percent > 0 && percent <= 65535) {
+                    sorted.push_back({start, percent});
+                }
+            }
+            if (sorted.empty()) {
+                sorted.push_back({0, 100});
+            }
+            std::sort(sorted.begin(), sorted.end());
+            for (const auto& breakpoint : sorted) {
+                profileStartMinutes.push_back(static_cast<unsigned short>(breakpoint.first));
+                profilePercents.push_back(static_cast<unsigned short>(breakpoint.second));
+            }
+            profileOffsets.push_back(static_cast<int>(profileStartMinutes.size()));
+            profileNames.push_back(name);
+        }
+    }
+    
+    // Edges are read before the profiles; drop references to missing ones
+    for (auto it = edgeProfiles.begin(); it != edgeProfiles.end();) {
+        if (it->second >= static_cast<int>(profileNames.size())) {
+            it = edgeProfiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    graphVersion++;
+    
     file.close();
 }
 
-// Save graph to file
-void HospitalGraph::saveToFile() {
-    std::ofstream file("hospitalGraph.txt");
+void HospitalGraph::writeToFile(const std::string& filename) {
+    std::ofstream file(filename);
     if (file.is_open()) {
         // Save nodes
         for (auto node : nodes) {
-            file << node->nodeID << " |" << node->name << "|" << node->type << "|\n";
+            file << node->nodeID << " |" << node->name << "|" << node->type << "|";
+            if (node->hasLocation) {
+                file << node->building << "|" << node->floor << " " << node->x << " " << node->y << "|";
+            }
+            file << "\n";
         }
         
         file << "EDGES:\n";
         
-        // Save edges (only once per pair)
-        std::vector<std::pair<int, int>> savedEdges;
+        // Save edges once per pair, from the lower node ID
         for (auto node : nodes) {
             for (const auto& neighbor : node->neighbors) {
-                int fromID = node->nodeID;
-                int toID = neighbor.first->nodeID;
-                
-                // Check if already saved
-                bool alreadySaved = false;
-                for (const auto& saved : savedEdges) {
-                    if ((saved.first == fromID && saved.second == toID) ||
-                        (saved.first == toID && saved.second == fromID)) {
-                        alreadySaved = true;
-                        break;
+                if (node->nodeID < neighbor.first->nodeID) {
+                    file << node->nodeID << " " << neighbor.first->nodeID << " " << neighbor.second;
+                    long long key = edgeKey(node->nodeID, neighbor.first->nodeID);
+                    auto profile = edgeProfiles.find(key);
+                    auto capacity = edgeCapacities.find(key);
+                    if (profile != edgeProfiles.end() || capacity != edgeCapacities.end()) {
+                        file << " " << (profile != edgeProfiles.end() ? profile->second : -1);
                     }
+                    if (capacity != edgeCapacities.end()) {
+                        file << " " << capacity->second;
+                    }
+                    file << "\n";
                 }
-                
-                if (!alreadySaved) {
-                    file << fromID << " " << toID << " " << neighbor.second << "\n";
-                    savedEdges.push_back({fromID, toID});
+            }
+        }
+        
+        if (!profileNames.empty()) {
+            file << "PROFILES:\n";
+            for (size_t p = 0; p < profileNames.size(); p++) {
+                file << p << " |" << profileNames[p] << "|";
+                for (int i = profileOffsets[p]; i < profileOffsets[p + 1]; i++) {
+                    file << profileStartMinutes[i] << " " << profilePercents[i];
+                    if (i < profileOffsets[p + 1] - 1) file << ";";
                 }
+                file << "|\n";
             }
         }
         
@@ -433,5 +1542,60 @@ void HospitalGraph::saveToFile() {
     }
 }
 
-
-
+// Benchmark on a scratch graph (hospitalGraph.txt is not touched)
+void HospitalGraph::runBenchmark(int edgeCount) {
+    typedef std::chrono::steady_clock Clock;
+    auto seconds = [](Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+    
+    int nodeCount = std::max(2, edgeCount / 5); // Average degree of 10
+    long long maxEdges = static_cast<long long>(nodeCount) * (nodeCount - 1) / 2;
+    edgeCount = static_cast<int>(std::min<long long>(edgeCount, maxEdges));
+    std::mt19937 rng(42);
+    const std::string filename = "graph_benchmark.txt";
+    
+    HospitalGraph scratch(false);
+    
+    Clock::time_point start = Clock::now();
+    for (int i = 1; i <= nodeCount; i++) {
+        scratch.insertNode(i, "Room " + std::to_string(i), i % 50 == 0 ? "Department" : "Ward");
+    }
+    int added = 0;
+    while (added < edgeCount) {
+        GraphNode* a = scratch.nodes[rng() % nodeCount];
+        GraphNode* b = scratch.nodes[rng() % nodeCount];
+        if (a != b && scratch.insertEdge(a, b, 1 + static_cast<int>(rng() % 20))) {
+            added++;
+        }
+    }
+    double buildTime = seconds(start);
+    
+    start = Clock::now();
+    const int LOOKUPS = 100000;
+    int found = 0;
+    for (int i = 0; i < LOOKUPS; i++) {
+        int id = 1 + static_cast<int>(rng() % nodeCount);
+        if (scratch.findNode(id) != nullptr) found++;
+        if (scratch.findNodeByName("Room " + std::to_string(id)) != nullptr) found++;
+    }
+    double lookupTime = seconds(start);
+    
+    start = Clock::now();
+    scratch.writeToFile(filename);
+    double saveTime = seconds(start);
+    
+    HospitalGraph reloaded(false);
+    start = Clock::now();
+    reloaded.readFromFile(filename);
+    double loadTime = seconds(start);
+    std::remove(filename.c_str());
+    
+    std::cout << "\n========== GRAPH BENCHMARK ==========\n";
+    std::cout << "Nodes: " << nodeCount << ", Edges: " << edgeCount << "\n";
+    std::cout << "Build: " << buildTime << " s\n";
+    std::cout << "Lookups: " << 2 * LOOKUPS << " in " << lookupTime << " s (" << found << " found)\n";
+    std::cout << "Save: " << saveTime << " s\n";
+    std::cout << "Load: " << loadTime << " s (" << reloaded.edgeSet.size() << " edges reloaded)\n";
+    std::cout << "=====================================\n";
+}
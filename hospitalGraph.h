@@ -4,32 +4,153 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
 
 // Graph Node structure (represents a department or location)
 struct GraphNode {
     int nodeID;
+    int index;        // Dense position in HospitalGraph::nodes (used by the CSR snapshot)
     std::string name; // Department name or location
     std::string type; // Department, Ward, Emergency, etc.
     
+    // Optional location in a campus-wide coordinate frame (same units as distances)
+    bool hasLocation;
+    std::string building;
+    int floor;
+    double x;
+    double y;
+    
     // Adjacency list
     std::vector<std::pair<GraphNode*, int>> neighbors; // (neighbor, distance/weight)
     
     GraphNode(int id, std::string n, std::string t);
 };
 
+// Frozen compressed-sparse-row snapshot of the adjacency lists.
+// Neighbors of node i are targets/weights[offsets[i] .. offsets[i + 1]).
+struct GraphCSR {
+    std::vector<int> offsets;
+    std::vector<int> targets; // Dense node indices
+    std::vector<int> weights;
+    std::vector<int> profiles; // Time-of-day weight profile per edge (-1 = static)
+};
+
+// Nearest facility of one type for every node (multi-source Dijkstra result)
+struct FacilityAssignment {
+    unsigned long version;      // graphVersion this assignment was computed for
+    std::vector<int> facility;  // Dense index of the nearest facility (-1 if unreachable)
+    std::vector<int> distance;
+    std::vector<int> nextHop;   // Next node on the route towards that facility
+};
+
+// Computed route kept in the LRU route cache
+struct RouteCacheEntry {
+    long long key;          // (from index, to index) packed
+    bool found;
+    int distance;
+    std::vector<int> path;  // Dense node indices
+};
+
 // Hospital Graph Class using Adjacency List
 class HospitalGraph {
 private:
     std::vector<GraphNode*> nodes;
     int nodeCounter;
+    bool persistent; // false for scratch graphs that never touch hospitalGraph.txt
+    
+    // Hash indexes for node lookup and the undirected edge set keyed by edgeKey()
+    std::unordered_map<int, GraphNode*> nodesByID;
+    std::unordered_map<std::string, GraphNode*> nodesByName;
+    std::unordered_set<long long> edgeSet;
+    
+    // Bumped on every structural change; the CSR snapshot is rebuilt lazily
+    unsigned long graphVersion;
+    unsigned long csrVersion;
+    GraphCSR csr;
+    
+    // All-pairs distance and next-hop tables (row-major, V x V), built on
+    // first route query and repaired in place when edges are added/shortened.
+    // Capped at 1024 nodes (8 MiB for both tables); larger graphs route with
+    // Dijkstra and the route cache instead.
+    static const size_t ROUTE_TABLE_MAX_NODES = 1024;
+    std::vector<int> routeDist;
+    std::vector<int> routeNext;
+    size_t routeTableSize;
+    bool routeTableValid;
+    
+    // Lower bound on the cost of changing one floor by lift or stairs (A* heuristic)
+    static const int FLOOR_CHANGE_COST = 10;
+    
+    // Disjoint-set forest over dense node indices (connected components)
+    std::vector<int> componentParent;
+    std::vector<int> componentRank;
+    int componentCount;
+    
+    // Cached nearest-facility assignments keyed by node type
+    std::unordered_map<std::string, FacilityAssignment> facilityCache;
+    
+    // Time-of-day weight profiles, stored flat: profile p owns breakpoints
+    // [profileOffsets[p], profileOffsets[p + 1]), each a start minute of the
+    // day and the percentage of the base distance that applies from then on.
+    // Edges reference a shared profile by ID, so memory stays linear in edges.
+    std::vector<std::string> profileNames;
+    std::vector<int> profileOffsets;
+    std::vector<unsigned short> profileStartMinutes;
+    std::vector<unsigned short> profilePercents;
+    std::unordered_map<long long, int> edgeProfiles;
+    
+    // Corridor capacities in people per minute (evacuation max-flow).
+    // Edges without an entry carry DEFAULT_EDGE_CAPACITY.
+    static const int DEFAULT_EDGE_CAPACITY = 10;
+    std::unordered_map<long long, int> edgeCapacities;
+    
+    // Bounded LRU cache of computed routes (most recent at the front).
+    // Entries belong to routeCacheVersion and are dropped when the graph changes.
+    std::list<RouteCacheEntry> routeCache;
+    std::unordered_map<long long, std::list<RouteCacheEntry>::iterator> routeCacheIndex;
+    size_t routeCacheCapacity;
+    unsigned long routeCacheVersion;
+    unsigned long routeCacheHits;
+    unsigned long routeCacheMisses;
+    unsigned long routeCacheEvictions;
+    unsigned long routeCacheInvalidations;
     
     // Helper functions
     GraphNode* findNode(int nodeID);
     GraphNode* findNodeByName(const std::string& name);
-    void DFSHelper(GraphNode* node, std::vector<bool>& visited);
+    static long long edgeKey(int a, int b);
+    GraphNode* insertNode(int id, std::string name, std::string type);
+    bool insertEdge(GraphNode* fromNode, GraphNode* toNode, int distance);
+    void readFromFile(const std::string& filename);
+    void writeToFile(const std::string& filename);
+    const GraphCSR& snapshot();
+    void DFSHelper(int start, std::vector<bool>& visited, std::vector<int>& component);
+    int findComponent(int index);
+    void uniteComponents(int a, int b);
+    void rebuildComponents();
+    const FacilityAssignment& facilityAssignment(const std::string& type);
+    bool dijkstra(int fromIndex, int toIndex, std::vector<int>& path, int& distance);
+    void printPath(const std::vector<int>& path, int distance);
+    void singleSourceRoutes(int source, int* dist, int* next);
+    bool ensureRouteTable();
+    void extendRouteTable();
+    void relaxRouteTable(int u, int v, int weight);
+    bool lookupRoute(int fromIndex, int toIndex, std::vector<int>& path, int& distance);
+    bool findRoute(int fromIndex, int toIndex, std::vector<int>& path, int& distance);
+    double heuristic(int fromIndex, int toIndex);
+    int weightAt(int distance, int profile, int minuteOfDay);
+    int edgeDelay(int distance, int profile, int minuteOfDay);
+    bool timeDependentDijkstra(int fromIndex, int toIndex, int departureMinute,
+                               std::vector<int>& path, int& travelTime);
+    bool astar(int fromIndex, int toIndex, std::vector<int>& path, int& distance, int& explored);
+    int edgeCapacity(int fromID, int toID);
+    long long maxFlow(const std::vector<int>& sources, const std::vector<int>& sinks,
+                      std::vector<long long>& sinkFlow, std::vector<std::pair<int, int>>& cutEdges);
     
 public:
-    HospitalGraph();
+    HospitalGraph(bool persistent = true);
     ~HospitalGraph();
     
     // Main functions
@@ -40,11 +161,31 @@ public:
     void viewGraph();
     void viewNode(int nodeID);
     void viewConnections(int nodeID);
+    void setNodeLocation(int nodeID, std::string building, int floor, double x, double y);
     
     // Graph algorithms
     void shortestPath(int fromID, int toID);
+    void astarPath(int fromID, int toID);
+    
+    // Congestion-aware routing with time-of-day weight profiles
+    int addWeightProfile(std::string name, const std::vector<std::pair<int, int>>& breakpoints);
+    void setEdgeProfile(int fromID, int toID, int profileID);
+    void viewWeightProfiles();
+    void timeDependentPath(int fromID, int toID, int departureMinute);
+    
+    // Evacuation planning: corridor capacities and ward-to-exit max-flow/min-cut
+    void setEdgeCapacity(int fromID, int toID, int capacity);
+    void evacuationAnalysis(const std::vector<int>& wardIDs, const std::vector<int>& exitIDs);
+    
+    // Route cache sizing and instrumentation
+    void setRouteCacheCapacity(size_t capacity);
+    void viewRouteCacheStats();
     void departmentConnections();
+    void nearestFacility(int fromID, const std::string& type);
+    void viewFacilityCoverage(const std::string& type);
     void findConnectedComponents();
+    bool areConnected(int fromID, int toID);
+    void checkConnectivity(int fromID, int toID);
     
     // File operations
     void loadFromFile();
@@ -52,6 +193,9 @@ public:
     
     // Initialize with sample data
     void initializeSampleData();
+    
+    // Build, save and reload a synthetic graph and report timings
+    void runBenchmark(int edgeCount);
 };
 
 #endif
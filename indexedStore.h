@@ -0,0 +1,276 @@
+#ifndef INDEXED_STORE_H
+#define INDEXED_STORE_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "nodePool.h"
+
+// Ordered record store shared by the Patient, Doctor and Medicine managers:
+// an AVL tree keyed on one record field, chosen at compile time through
+// KeyField, with its nodes allocated from a NodePool. Nodes are relinked
+// (never copied) on erase, so a Record* stays valid until that record
+// itself is erased.
+//
+// Secondary indexes plug in through attachIndex(): the store calls their add
+// hook after linking a record and their remove hook before destroying one,
+// so insert/erase keep every index in step. Field changes go through
+// update(), which takes the record out of the indexes around the edit.
+// Record line formats are described separately (recordFields.h).
+template <typename Record, typename Key, Key Record::*KeyField>
+class IndexedStore {
+private:
+    struct Node : Record {
+        Node* left;
+        Node* right;
+        int height;
+
+        template <typename... Args>
+        explicit Node(Args&&... args)
+            : Record(std::forward<Args>(args)...), left(nullptr), right(nullptr), height(1) {}
+    };
+
+    struct IndexHooks {
+        std::function<void(Record&)> add;
+        std::function<void(Record&)> remove;
+    };
+
+    Node* root;
+    size_t count;
+    NodePool<Node> pool;
+    std::vector<IndexHooks> indexes;
+
+    static const Key& keyOf(const Node* node) { return node->*KeyField; }
+    static int heightOf(const Node* node) { return node == nullptr ? 0 : node->height; }
+
+    static void update(Node* node) {
+        int left = heightOf(node->left);
+        int right = heightOf(node->right);
+        node->height = (left > right ? left : right) + 1;
+    }
+
+    static Node* rotateRight(Node* node) {
+        Node* pivot = node->left;
+        node->left = pivot->right;
+        pivot->right = node;
+        update(node);
+        update(pivot);
+        return pivot;
+    }
+
+    static Node* rotateLeft(Node* node) {
+        Node* pivot = node->right;
+        node->right = pivot->left;
+        pivot->left = node;
+        update(node);
+        update(pivot);
+        return pivot;
+    }
+
+    static Node* rebalance(Node* node) {
+        update(node);
+        int balance = heightOf(node->left) - heightOf(node->right);
+        if (balance > 1) {
+            if (heightOf(node->left->left) < heightOf(node->left->right))
+                node->left = rotateLeft(node->left);
+            return rotateRight(node);
+        }
+        if (balance < -1) {
+            if (heightOf(node->right->right) < heightOf(node->right->left))
+                node->right = rotateRight(node->right);
+            return rotateLeft(node);
+        }
+        return node;
+    }
+
+    static Node* link(Node* node, Node* newNode, bool& inserted) {
+        if (node == nullptr) {
+            inserted = true;
+            return newNode;
+        }
+        if (keyOf(newNode) < keyOf(node))
+            node->left = link(node->left, newNode, inserted);
+        else if (keyOf(node) < keyOf(newNode))
+            node->right = link(node->right, newNode, inserted);
+        else
+            return node;
+        return inserted ? rebalance(node) : node;
+    }
+
+    // Detaches the smallest node of a subtree into `minNode`
+    static Node* unlinkMin(Node* node, Node*& minNode) {
+        if (node->left == nullptr) {
+            minNode = node;
+            return node->right;
+        }
+        node->left = unlinkMin(node->left, minNode);
+        return rebalance(node);
+    }
+
+    static Node* unlink(Node* node, const Key& key, Node*& removed) {
+        if (node == nullptr)
+            return nullptr;
+        if (key < keyOf(node)) {
+            node->left = unlink(node->left, key, removed);
+        } else if (keyOf(node) < key) {
+            node->right = unlink(node->right, key, removed);
+        } else {
+            removed = node;
+            if (node->left == nullptr)
+                return node->right;
+            if (node->right == nullptr)
+                return node->left;
+            Node* successor = nullptr;
+            Node* right = unlinkMin(node->right, successor);
+            successor->left = node->left;
+            successor->right = right;
+            return rebalance(successor);
+        }
+        return removed != nullptr ? rebalance(node) : node;
+    }
+
+    Node* findNode(const Key& key) const {
+        Node* node = root;
+        while (node != nullptr) {
+            if (key < keyOf(node))
+                node = node->left;
+            else if (keyOf(node) < key)
+                node = node->right;
+            else
+                return node;
+        }
+        return nullptr;
+    }
+
+    void notifyAdd(Record& record) {
+        for (IndexHooks& index : indexes)
+            index.add(record);
+    }
+
+    void notifyRemove(Record& record) {
+        for (IndexHooks& index : indexes)
+            index.remove(record);
+    }
+
+    // Frees every node without notifying the indexes
+    void release() {
+        std::vector<Node*> pending;
+        if (root != nullptr)
+            pending.push_back(root);
+        while (!pending.empty()) {
+            Node* node = pending.back();
+            pending.pop_back();
+            if (node->left != nullptr)
+                pending.push_back(node->left);
+            if (node->right != nullptr)
+                pending.push_back(node->right);
+            pool.destroy(node);
+        }
+        root = nullptr;
+        count = 0;
+    }
+
+public:
+    typedef Record RecordType;
+
+    IndexedStore() : root(nullptr), count(0) {}
+    // The owner's indexes may already be gone, so they are not notified
+    ~IndexedStore() { release(); }
+
+    IndexedStore(const IndexedStore&) = delete;
+    IndexedStore& operator=(const IndexedStore&) = delete;
+
+    // Allocates a record without linking it; pass it to insert() or destroy()
+    template <typename... Args>
+    Record* create(Args&&... args) {
+        return pool.create(std::forward<Args>(args)...);
+    }
+
+    void destroy(Record* record) {
+        pool.destroy(static_cast<Node*>(record));
+    }
+
+    // Registers a secondary index; records already stored are added to it
+    void attachIndex(std::function<void(Record&)> add, std::function<void(Record&)> remove) {
+        indexes.push_back(IndexHooks{std::move(add), std::move(remove)});
+        IndexHooks& index = indexes.back();
+        forEach([&index](Record& record) { index.add(record); });
+    }
+
+    // Links a record from create(); false (record left unlinked) if the key exists
+    bool insert(Record* record) {
+        bool inserted = false;
+        root = link(root, static_cast<Node*>(record), inserted);
+        if (!inserted)
+            return false;
+        count++;
+        notifyAdd(*record);
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        Node* removed = nullptr;
+        root = unlink(root, key, removed);
+        if (removed == nullptr)
+            return false;
+        notifyRemove(*removed);
+        pool.destroy(removed);
+        count--;
+        return true;
+    }
+
+    // Applies edit(record) with the record taken out of every index; the
+    // edit must not change the key
+    template <typename Edit>
+    bool update(const Key& key, Edit edit) {
+        Node* node = findNode(key);
+        if (node == nullptr)
+            return false;
+        notifyRemove(*node);
+        edit(*static_cast<Record*>(node));
+        notifyAdd(*node);
+        return true;
+    }
+
+    Record* find(const Key& key) const { return findNode(key); }
+    bool contains(const Key& key) const { return findNode(key) != nullptr; }
+
+    Record* last() const {
+        Node* node = root;
+        while (node != nullptr && node->right != nullptr)
+            node = node->right;
+        return node;
+    }
+
+    // Visits every record in key order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        std::vector<Node*> path;
+        Node* node = root;
+        while (node != nullptr || !path.empty()) {
+            while (node != nullptr) {
+                path.push_back(node);
+                node = node->left;
+            }
+            node = path.back();
+            path.pop_back();
+            visit(*static_cast<Record*>(node));
+            node = node->right;
+        }
+    }
+
+    void clear() {
+        if (!indexes.empty())
+            forEach([this](Record& record) { notifyRemove(record); });
+        release();
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    int height() const { return heightOf(root); }
+    const NodePool<Node>& nodePool() const { return pool; }
+    static size_t nodeBytes() { return sizeof(Node); }
+};
+
+#endif
@@ -36,6 +36,7 @@ int main()
     cout << "  DSA-Based Modular System" << endl;
     cout << "========================================" << endl
          << endl;
+    billingMgr.recoverDispenses(pharmacyMgr);
     cout << "System loaded successfully!" << endl;
     pause();
 
@@ -119,7 +120,18 @@ void showPatientMenu()
         cout << "3. View All Patients" << endl;
         cout << "4. Update Patient Information" << endl;
         cout << "5. Delete Patient" << endl;
-        cout << "6. Back to Main Menu" << endl;
+        cout << "6. Search Patient by Phone" << endl;
+        cout << "7. Search Patients by Name" << endl;
+        cout << "8. View Patients by Blood Group" << endl;
+        cout << "9. Fuzzy Name Search" << endl;
+        cout << "10. Find Possible Duplicate Patients" << endl;
+        cout << "11. Search Medical History (AND/OR)" << endl;
+        cout << "12. Filter Patients by Age and Blood Group" << endl;
+        cout << "13. View Storage Statistics" << endl;
+        cout << "14. Cohort Query (Filter and Group)" << endl;
+        cout << "15. Run Cohort Scan Benchmark" << endl;
+        cout << "16. Run Record Load Benchmark" << endl;
+        cout << "17. Back to Main Menu" << endl;
         cout << "========================================" << endl;
         choice = getValidInt("Enter your choice: ");
         switch (choice)
@@ -146,11 +158,122 @@ void showPatientMenu()
         case 5:
         {
             int id = getValidInt("Enter Patient ID: ");
+            bool existed = patientMgr.patientExists(id);
             patientMgr.deletePatient(id);
+            if (existed)
+                doctorMgr.removePatientAssignments(id);
             break;
         }
+        case 6:
+        {
+            string phone = getValidString("Enter Phone Number: ");
+            patientMgr.searchPatientByPhone(phone);
+            pause();
+            break;
+        }
+        case 7:
+        {
+            string prefix = getValidString("Enter Name (or first letters): ");
+            patientMgr.searchPatientByName(prefix);
+            pause();
+            break;
+        }
+        case 8:
+        {
+            string bloodGroup = getValidString("Enter Blood Group: ");
+            patientMgr.viewPatientsByBloodGroup(bloodGroup);
+            pause();
+            break;
+        }
+        case 9:
+        {
+            string name = getValidString("Enter Name (approximate spelling): ");
+            patientMgr.fuzzySearchPatients(name);
+            pause();
+            break;
+        }
+        case 10:
+        {
+            int maxDistance = getValidInt("Enter Maximum Spelling Differences (e.g. 2): ");
+            patientMgr.findDuplicatePatients(maxDistance > 0 ? maxDistance : 1);
+            pause();
+            break;
+        }
+        case 11:
+        {
+            string query = getValidString("Enter Query (e.g. diabetes AND hypertension): ");
+            patientMgr.viewMedicalHistorySearch(query);
+            pause();
+            break;
+        }
+        case 12:
+        {
+            int minAge = getValidInt("Enter Minimum Age: ");
+            int maxAge = getValidInt("Enter Maximum Age: ");
+            cout << "Enter Blood Group (leave empty for any): ";
+            string bloodGroup;
+            getline(cin, bloodGroup);
+            patientMgr.filterPatients(minAge, maxAge, bloodGroup);
+            pause();
+            break;
+        }
+        case 13:
+            patientMgr.viewStorageStatistics();
+            pause();
+            break;
+        case 14:
+        {
+            CohortFilter filter;
+            filter.minAge = getValidInt("Enter Minimum Age: ");
+            filter.maxAge = getValidInt("Enter Maximum Age: ");
+            cout << "Enter Gender (leave empty for any): ";
+            getline(cin, filter.gender);
+            cout << "Enter Blood Group (leave empty for any): ";
+            getline(cin, filter.bloodGroup);
+            string date;
+            cout << "Registered From DD/MM/YYYY (leave empty for any): ";
+            getline(cin, date);
+            filter.registeredFrom = dateToDays(date);
+            cout << "Registered To DD/MM/YYYY (leave empty for any): ";
+            getline(cin, date);
+            filter.registeredTo = dateToDays(date);
+            int doctorID = getValidInt("Enter Assigned Doctor ID (0 for any): ");
+            if (doctorID > 0)
+            {
+                filter.byPatients = true;
+                filter.patientIDs = doctorMgr.getAssignedPatients(doctorID);
+            }
+            cout << "Group by: 0. None  1. Gender  2. Blood Group  3. Age Band  4. Doctor" << endl;
+            int groupChoice = getValidInt("Enter your choice: ");
+            CohortGroup group = groupChoice >= 1 && groupChoice <= 4 ? static_cast<CohortGroup>(groupChoice) : GROUP_NONE;
+            vector<PatientSet> doctorGroups;
+            if (group == GROUP_DOCTOR)
+            {
+                for (int id : doctorMgr.getAllDoctorIDs())
+                {
+                    doctorGroups.push_back(PatientSet{"Doctor " + to_string(id), doctorMgr.getAssignedPatients(id)});
+                }
+            }
+            patientMgr.runCohortQuery(filter, group, doctorGroups);
+            pause();
+            break;
+        }
+        case 15:
+        {
+            int rows = getValidInt("Enter Number of Rows (e.g. 1000000): ");
+            patientMgr.runCohortBenchmark(rows > 0 ? rows : 1000000);
+            pause();
+            break;
+        }
+        case 16:
+        {
+            int rows = getValidInt("Enter Number of Records (e.g. 1000000): ");
+            patientMgr.runLoadBenchmark(rows > 0 ? rows : 1000000);
+            pause();
+            break;
         }
-    } while (choice != 6);
+        }
+    } while (choice != 17);
 }
 
 void showDoctorMenu()
@@ -169,7 +292,9 @@ void showDoctorMenu()
         cout << "4. Update Doctor Information" << endl;
         cout << "5. Assign Patient to Doctor" << endl;
         cout << "6. View Assigned Patients" << endl;
-        cout << "7. Back to Main Menu" << endl;
+        cout << "7. Unassign Patient from Doctor" << endl;
+        cout << "8. View Doctors of a Patient" << endl;
+        cout << "9. Back to Main Menu" << endl;
         cout << "========================================" << endl;
         choice = getValidInt("Enter your choice: ");
         switch (choice)
@@ -208,8 +333,23 @@ void showDoctorMenu()
             pause();
             break;
         }
+        case 7:
+        {
+            int doctorID = getValidInt("Enter Doctor ID: ");
+            int patientID = getValidInt("Enter Patient ID: ");
+            doctorMgr.unassignPatient(doctorID, patientID);
+            pause();
+            break;
         }
-    } while (choice != 7);
+        case 8:
+        {
+            int patientID = getValidInt("Enter Patient ID: ");
+            doctorMgr.viewPatientDoctors(patientID);
+            pause();
+            break;
+        }
+        }
+    } while (choice != 9);
 }
 
 void showAppointmentMenu()
@@ -330,10 +470,17 @@ void showPharmacyMenu()
         cout << "1. Add Medicine" << endl;
         cout << "2. View Medicine" << endl;
         cout << "3. View All Inventory" << endl;
-        cout << "4. Update Stock" << endl;
-        cout << "5. Remove Medicine" << endl;
-        cout << "6. Search Medicine by Name" << endl;
-        cout << "7. Back to Main Menu" << endl;
+        cout << "4. Receive Stock (New Lot)" << endl;
+        cout << "5. Dispense Medicine" << endl;
+        cout << "6. Remove Medicine" << endl;
+        cout << "7. Search Medicine by Name" << endl;
+        cout << "8. Search Medicine by Prefix" << endl;
+        cout << "9. View Expiring Medicines" << endl;
+        cout << "10. Run Daily Expiry Sweep" << endl;
+        cout << "11. Set Reorder Level" << endl;
+        cout << "12. View Reorder Report" << endl;
+        cout << "13. Dispensing Stress Test" << endl;
+        cout << "14. Back to Main Menu" << endl;
         cout << "========================================" << endl;
         choice = getValidInt("Enter your choice: ");
         switch (choice)
@@ -354,26 +501,77 @@ void showPharmacyMenu()
         case 4:
         {
             int id = getValidInt("Enter Medicine ID: ");
-            int qty = getValidInt("Enter quantity to add (negative to subtract): ");
-            pharmacyMgr.updateStock(id, qty);
+            int qty = getValidInt("Enter Quantity Received: ");
+            string expiryDate = getValidString("Enter Expiry Date (DD/MM/YYYY): ");
+            string batchNumber = getValidString("Enter Batch Number: ");
+            pharmacyMgr.receiveStock(id, qty, expiryDate, batchNumber);
             pause();
             break;
         }
         case 5:
         {
             int id = getValidInt("Enter Medicine ID: ");
-            pharmacyMgr.removeMedicine(id);
+            int qty = getValidInt("Enter Quantity to Dispense: ");
+            pharmacyMgr.dispenseMedicine(id, qty);
+            pause();
             break;
         }
         case 6:
+        {
+            int id = getValidInt("Enter Medicine ID: ");
+            pharmacyMgr.removeMedicine(id);
+            break;
+        }
+        case 7:
         {
             string name = getValidString("Enter Medicine Name: ");
             pharmacyMgr.searchMedicineByName(name);
             pause();
             break;
         }
+        case 8:
+        {
+            string prefix = getValidString("Enter Name Prefix: ");
+            pharmacyMgr.searchMedicineByPrefix(prefix);
+            pause();
+            break;
         }
-    } while (choice != 7);
+        case 9:
+        {
+            int days = getValidInt("Enter number of days: ");
+            if (days < 0)
+                cout << "Number of days cannot be negative!" << endl;
+            else
+                pharmacyMgr.viewExpiringMedicines(days);
+            pause();
+            break;
+        }
+        case 10:
+            pharmacyMgr.runExpirySweep();
+            pause();
+            break;
+        case 11:
+        {
+            int id = getValidInt("Enter Medicine ID: ");
+            int level = getValidInt("Enter Reorder Level (0 for none): ");
+            pharmacyMgr.setReorderLevel(id, level);
+            pause();
+            break;
+        }
+        case 12:
+            pharmacyMgr.viewReorderReport();
+            pause();
+            break;
+        case 13:
+        {
+            int id = getValidInt("Enter Medicine ID: ");
+            int threads = getValidInt("Enter Number of Threads: ");
+            pharmacyMgr.runDispenseStressTest(id, threads);
+            pause();
+            break;
+        }
+        }
+    } while (choice != 14);
 }
 
 void showBillingMenu()
@@ -392,7 +590,8 @@ void showBillingMenu()
         cout << "4. Update Bill" << endl;
         cout << "5. Mark Bill as Paid" << endl;
         cout << "6. Sort Bills by Amount" << endl;
-        cout << "7. Back to Main Menu" << endl;
+        cout << "7. Dispense Prescription" << endl;
+        cout << "8. Back to Main Menu" << endl;
         cout << "========================================" << endl;
         choice = getValidInt("Enter your choice: ");
         switch (choice)
@@ -424,8 +623,31 @@ void showBillingMenu()
         case 6:
             billingMgr.sortBillsByAmount();
             break;
+        case 7:
+        {
+            clearScreen();
+            cout << "========== DISPENSE PRESCRIPTION ==========" << endl
+                 << endl;
+            int patientID = getValidInt("Enter Patient ID: ");
+            if (!patientMgr.patientExists(patientID))
+            {
+                cout << "Patient with ID " << patientID << " not found!" << endl;
+                pause();
+                break;
+            }
+            vector<pair<int, int>> items;
+            int medicineID;
+            while ((medicineID = getValidInt("Enter Medicine ID (0 to finish): ")) != 0)
+            {
+                int qty = getValidInt("Enter Quantity: ");
+                items.push_back({medicineID, qty});
+            }
+            billingMgr.dispensePrescription(pharmacyMgr, patientID, items);
+            pause();
+            break;
         }
-    } while (choice != 7);
+        }
+    } while (choice != 8);
 }
 
 void showGraphMenu()
@@ -445,7 +667,22 @@ void showGraphMenu()
         cout << "5. View Connections" << endl;
         cout << "6. Find Shortest Path" << endl;
         cout << "7. View Department Connections" << endl;
-        cout << "8. Back to Main Menu" << endl;
+        cout << "8. Find Route (A*)" << endl;
+        cout << "9. Set Node Location" << endl;
+        cout << "10. Check Connectivity" << endl;
+        cout << "11. View Connected Components" << endl;
+        cout << "12. Run Graph Benchmark" << endl;
+        cout << "13. Find Nearest Facility by Type" << endl;
+        cout << "14. View Facility Coverage by Type" << endl;
+        cout << "15. View Route Cache Statistics" << endl;
+        cout << "16. Set Route Cache Capacity" << endl;
+        cout << "17. Add Weight Profile (Time of Day)" << endl;
+        cout << "18. View Weight Profiles" << endl;
+        cout << "19. Assign Profile to Edge" << endl;
+        cout << "20. Find Time-Dependent Route" << endl;
+        cout << "21. Set Corridor Capacity" << endl;
+        cout << "22. Evacuation Analysis (Max Flow)" << endl;
+        cout << "23. Back to Main Menu" << endl;
         cout << "========================================" << endl;
         choice = getValidInt("Enter your choice: ");
         switch (choice)
@@ -495,8 +732,149 @@ void showGraphMenu()
         case 7:
             hospitalGraph.departmentConnections();
             break;
+        case 8:
+        {
+            int fromID = getValidInt("Enter From Node ID: ");
+            int toID = getValidInt("Enter To Node ID: ");
+            hospitalGraph.astarPath(fromID, toID);
+            pause();
+            break;
         }
-    } while (choice != 8);
+        case 9:
+        {
+            int id = getValidInt("Enter Node ID: ");
+            string building = getValidString("Enter Building: ");
+            int floor = getValidInt("Enter Floor: ");
+            int x = getValidInt("Enter X Coordinate: ");
+            int y = getValidInt("Enter Y Coordinate: ");
+            hospitalGraph.setNodeLocation(id, building, floor, x, y);
+            pause();
+            break;
+        }
+        case 10:
+        {
+            int fromID = getValidInt("Enter From Node ID: ");
+            int toID = getValidInt("Enter To Node ID: ");
+            hospitalGraph.checkConnectivity(fromID, toID);
+            pause();
+            break;
+        }
+        case 11:
+            clearScreen();
+            cout << "========== CONNECTED COMPONENTS ==========" << endl;
+            hospitalGraph.findConnectedComponents();
+            pause();
+            break;
+        case 12:
+        {
+            int edges = getValidInt("Enter Number of Edges (e.g. 50000): ");
+            hospitalGraph.runBenchmark(edges);
+            pause();
+            break;
+        }
+        case 13:
+        {
+            int id = getValidInt("Enter Current Node ID: ");
+            string type = getValidString("Enter Facility Type (Department/Ward/etc): ");
+            hospitalGraph.nearestFacility(id, type);
+            pause();
+            break;
+        }
+        case 14:
+        {
+            string type = getValidString("Enter Facility Type (Department/Ward/etc): ");
+            hospitalGraph.viewFacilityCoverage(type);
+            pause();
+            break;
+        }
+        case 15:
+            hospitalGraph.viewRouteCacheStats();
+            pause();
+            break;
+        case 16:
+        {
+            int capacity = getValidInt("Enter Cache Capacity (routes): ");
+            hospitalGraph.setRouteCacheCapacity(capacity > 0 ? capacity : 0);
+            pause();
+            break;
+        }
+        case 17:
+        {
+            string name = getValidString("Enter Profile Name: ");
+            vector<pair<int, int>> breakpoints;
+            cout << "Enter breakpoints (hour -1 to finish):" << endl;
+            while (true)
+            {
+                int hour = getValidInt("  Start Hour (0-23): ");
+                if (hour < 0)
+                    break;
+                int minute = getValidInt("  Start Minute (0-59): ");
+                int percent = getValidInt("  Percent of Base Distance: ");
+                breakpoints.push_back({hour * 60 + minute, percent});
+            }
+            int id = hospitalGraph.addWeightProfile(name, breakpoints);
+            if (id >= 0)
+                cout << "\nWeight profile added with ID: " << id << endl;
+            pause();
+            break;
+        }
+        case 18:
+            hospitalGraph.viewWeightProfiles();
+            pause();
+            break;
+        case 19:
+        {
+            int fromID = getValidInt("Enter From Node ID: ");
+            int toID = getValidInt("Enter To Node ID: ");
+            int profileID = getValidInt("Enter Profile ID (-1 for none): ");
+            hospitalGraph.setEdgeProfile(fromID, toID, profileID);
+            pause();
+            break;
+        }
+        case 20:
+        {
+            int fromID = getValidInt("Enter From Node ID: ");
+            int toID = getValidInt("Enter To Node ID: ");
+            int hour = getValidInt("Enter Departure Hour (0-23): ");
+            int minute = getValidInt("Enter Departure Minute (0-59): ");
+            hospitalGraph.timeDependentPath(fromID, toID, hour * 60 + minute);
+            pause();
+            break;
+        }
+        case 21:
+        {
+            int fromID = getValidInt("Enter From Node ID: ");
+            int toID = getValidInt("Enter To Node ID: ");
+            int capacity = getValidInt("Enter Capacity (people/minute): ");
+            hospitalGraph.setEdgeCapacity(fromID, toID, capacity);
+            pause();
+            break;
+        }
+        case 22:
+        {
+            vector<int> wardIDs, exitIDs;
+            cout << "Enter ward node IDs (0 to finish):" << endl;
+            while (true)
+            {
+                int id = getValidInt("  Ward Node ID: ");
+                if (id == 0)
+                    break;
+                wardIDs.push_back(id);
+            }
+            cout << "Enter exit node IDs (0 to finish):" << endl;
+            while (true)
+            {
+                int id = getValidInt("  Exit Node ID: ");
+                if (id == 0)
+                    break;
+                exitIDs.push_back(id);
+            }
+            hospitalGraph.evacuationAnalysis(wardIDs, exitIDs);
+            pause();
+            break;
+        }
+        }
+    } while (choice != 23);
 }
 
 void showAdminMenu()
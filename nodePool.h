@@ -0,0 +1,95 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Typed slab allocator for the linked-structure nodes (BST, list and queue
+// nodes). Slots are carved from a few large slabs that double in size up to
+// MAX_SLAB_SLOTS; freed slots go on an intrusive free list and are reused
+// before any new slab is requested. Destroying the pool releases every slab
+// in one pass, so it must outlive every node it handed out.
+template <typename T>
+class NodePool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static const size_t FIRST_SLAB_SLOTS = 64;
+    static const size_t MAX_SLAB_SLOTS = 65536;
+
+    std::vector<Slot*> slabs;
+    Slot* freeList;
+    Slot* cursor;     // Next never-used slot in the newest slab
+    Slot* slabEnd;
+    size_t nextSlabSlots;
+    size_t capacity;
+    size_t live;
+
+    Slot* takeSlot() {
+        if (freeList != nullptr) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            return slot;
+        }
+        if (cursor == slabEnd) {
+            Slot* slab = static_cast<Slot*>(::operator new(nextSlabSlots * sizeof(Slot)));
+            slabs.push_back(slab);
+            cursor = slab;
+            slabEnd = slab + nextSlabSlots;
+            capacity += nextSlabSlots;
+            if (nextSlabSlots < MAX_SLAB_SLOTS)
+                nextSlabSlots *= 2;
+        }
+        return cursor++;
+    }
+
+public:
+    NodePool()
+        : freeList(nullptr), cursor(nullptr), slabEnd(nullptr),
+          nextSlabSlots(FIRST_SLAB_SLOTS), capacity(0), live(0) {}
+
+    ~NodePool() {
+        for (size_t i = 0; i < slabs.size(); i++)
+            ::operator delete(slabs[i]);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = takeSlot();
+        T* node;
+        try {
+            node = new (slot->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->next = freeList;
+            freeList = slot;
+            throw;
+        }
+        live++;
+        return node;
+    }
+
+    void destroy(T* node) {
+        if (node == nullptr)
+            return;
+        node->~T();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    size_t liveCount() const { return live; }
+    size_t slotCapacity() const { return capacity; }
+    size_t slabCount() const { return slabs.size(); }
+    size_t bytesReserved() const { return capacity * sizeof(Slot); }
+};
+
+#endif
@@ -1,130 +1,293 @@
 #include "patient.h"
+#include "recordFields.h"
 #include "utils.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <iomanip>
+#include <chrono>
+#include <random>
 
 Patient::Patient(int id, std::string n, int a, std::string g, std::string addr,std::string ph, std::string bg, std::string mh)
-: patientID(id), name(n), age(a), gender(g), address(addr), phone(ph), bloodGroup(bg), medicalHistory(mh), left(nullptr), right(nullptr) {}
+: patientID(id), name(std::move(n)), age(a), gender(std::move(g)), address(std::move(addr)), phone(std::move(ph)), bloodGroup(std::move(bg)), medicalHistory(std::move(mh)) {}
 
-PatientManager::PatientManager() : root(nullptr)
-{
-    loadFromFile();
-}
+// patients.txt line: "id age |name|gender|address|phone|bloodGroup|medicalHistory|registrationDate|"
+typedef RecordFormat<Patient,
+                     FieldList<Field<Patient, int, &Patient::patientID>,
+                               Field<Patient, int, &Patient::age>>,
+                     FieldList<Field<Patient, std::string, &Patient::name>,
+                               Field<Patient, std::string, &Patient::gender>,
+                               Field<Patient, std::string, &Patient::address>,
+                               Field<Patient, std::string, &Patient::phone>,
+                               Field<Patient, std::string, &Patient::bloodGroup>,
+                               Field<Patient, std::string, &Patient::medicalHistory>,
+                               Field<Patient, std::string, &Patient::registrationDate>>>
+    PatientFormat;
 
-PatientManager::~PatientManager()
+// Distinct trigrams of a lowercase name, padded so short names and word
+// boundaries still produce grams ("amy" -> "  a", " am", "amy", "my ")
+static std::vector<unsigned int> nameTrigrams(const std::string &lowered)
 {
-    saveToFile();
-    clearTree(root);
+    std::string padded = "  " + lowered + " ";
+    std::vector<unsigned int> grams;
+    for (size_t i = 0; i + 2 < padded.size(); i++)
+    {
+        grams.push_back((static_cast<unsigned char>(padded[i]) << 16) |
+                        (static_cast<unsigned char>(padded[i + 1]) << 8) |
+                        static_cast<unsigned char>(padded[i + 2]));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
 }
 
-Patient *PatientManager::insertBST(Patient *node, Patient *newPatient)
+HistoryPostings::HistoryPostings() : count(0), lastID(0) {}
+
+// Distinct lowercase alphanumeric terms of a medical history. "and"/"or"
+// are skipped because they are query operators.
+static std::vector<std::string> historyTerms(const std::string &text)
 {
-    if (node == nullptr)
+    std::vector<std::string> terms;
+    std::string term;
+    for (size_t i = 0; i <= text.size(); i++)
     {
-        return newPatient;
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (std::isalnum(c))
+        {
+            term += static_cast<char>(std::tolower(c));
+        }
+        else if (!term.empty())
+        {
+            if (term.size() > 1 && term != "and" && term != "or")
+                terms.push_back(term);
+            term.clear();
+        }
     }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
 
-    if (newPatient->patientID < node->patientID)
-    {
-        node->left = insertBST(node->left, newPatient);
-    }
-    else if (newPatient->patientID > node->patientID)
+static void appendVarint(std::vector<unsigned char> &bytes, unsigned int value)
+{
+    while (value >= 0x80)
     {
-        node->right = insertBST(node->right, newPatient);
+        bytes.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
     }
-
-    return node;
+    bytes.push_back(static_cast<unsigned char>(value));
 }
 
-Patient *PatientManager::searchBST(Patient *node, int id)
+static std::vector<int> decodePostings(const HistoryPostings &postings)
 {
-    if (node == nullptr || node->patientID == id)
+    std::vector<int> ids;
+    ids.reserve(postings.count);
+    unsigned int value = 0;
+    int shift = 0;
+    int previous = 0;
+    for (unsigned char byte : postings.bytes)
     {
-        return node;
+        value |= static_cast<unsigned int>(byte & 0x7F) << shift;
+        if (byte & 0x80)
+        {
+            shift += 7;
+            continue;
+        }
+        previous += static_cast<int>(value);
+        ids.push_back(previous);
+        value = 0;
+        shift = 0;
     }
+    return ids;
+}
 
-    if (id < node->patientID)
-    {
-        return searchBST(node->left, id);
-    }
-    else
+static void encodePostings(HistoryPostings &postings, const std::vector<int> &ids)
+{
+    postings.bytes.clear();
+    int previous = 0;
+    for (int id : ids)
     {
-        return searchBST(node->right, id);
+        appendVarint(postings.bytes, static_cast<unsigned int>(id - previous));
+        previous = id;
     }
+    postings.count = static_cast<int>(ids.size());
+    postings.lastID = previous;
 }
 
-Patient *PatientManager::findMin(Patient *node)
+// Intersect a short sorted list with a long one, galloping (exponential
+// then binary search) through the long list from the last match
+static std::vector<int> gallopingIntersect(const std::vector<int> &shorter, const std::vector<int> &longer)
 {
-    while (node->left != nullptr)
+    std::vector<int> result;
+    size_t low = 0;
+    for (int id : shorter)
     {
-        node = node->left;
+        size_t step = 1;
+        size_t high = low;
+        while (high < longer.size() && longer[high] < id)
+        {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        auto it = std::lower_bound(longer.begin() + low, longer.begin() + std::min(high + 1, longer.size()), id);
+        low = it - longer.begin();
+        if (low == longer.size())
+            break;
+        if (*it == id)
+            result.push_back(id);
     }
-    return node;
+    return result;
+}
+
+PatientManager::PatientManager()
+    : deltaLog(records, "patients.txt", "patients_delta.txt", PatientFormat::write),
+      loadedRecords(0), loadAllocations(0), loadSeconds(0.0)
+{
+    records.attachIndex([this](Patient &patient) { indexPatient(&patient); },
+                        [this](Patient &patient) { unindexPatient(&patient); });
+    records.attachIndex([this](Patient &patient) { columns.upsert(&patient); },
+                        [this](Patient &patient) { columns.remove(patient.patientID); });
+    loadFromFile();
 }
 
-Patient *PatientManager::deleteBST(Patient *node, int id)
+PatientManager::~PatientManager()
 {
-    if (node == nullptr)
+    compactFile();
+}
+
+void PatientManager::indexPatient(Patient *patient)
+{
+    phoneIndex.emplace(normalizePhone(patient->phone), patient->patientID);
+    nameIndex.emplace(toLowerCase(patient->name), patient->patientID);
+    bloodGroupIndex[normalizeCode(patient->bloodGroup)].insert(patient->patientID);
+
+    std::string lowered = toLowerCase(patient->name);
+    for (unsigned int gram : nameTrigrams(lowered))
     {
-        return node;
+        // Postings stay sorted by ID; new IDs are normally the largest so this appends
+        std::vector<int> &ids = trigramIndex[gram];
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), patient->patientID), patient->patientID);
     }
+    nameByID[patient->patientID] = lowered;
 
-    if (id < node->patientID)
+    for (const std::string &term : historyTerms(patient->medicalHistory))
     {
-        node->left = deleteBST(node->left, id);
+        addHistoryPosting(term, patient->patientID);
     }
-    else if (id > node->patientID)
+}
+
+void PatientManager::unindexPatient(Patient *patient)
+{
+    auto range = phoneIndex.equal_range(normalizePhone(patient->phone));
+    for (auto it = range.first; it != range.second; ++it)
     {
-        node->right = deleteBST(node->right, id);
+        if (it->second == patient->patientID)
+        {
+            phoneIndex.erase(it);
+            break;
+        }
     }
-    else
+
+    nameIndex.erase({toLowerCase(patient->name), patient->patientID});
+
+    auto postings = bloodGroupIndex.find(normalizeCode(patient->bloodGroup));
+    if (postings != bloodGroupIndex.end())
     {
+        postings->second.erase(patient->patientID);
+        if (postings->second.empty())
+        {
+            bloodGroupIndex.erase(postings);
+        }
+    }
 
-        if (node->left == nullptr)
+    std::string lowered = toLowerCase(patient->name);
+    for (unsigned int gram : nameTrigrams(lowered))
+    {
+        auto grams = trigramIndex.find(gram);
+        if (grams == trigramIndex.end())
+            continue;
+
+        std::vector<int> &ids = grams->second;
+        auto it = std::lower_bound(ids.begin(), ids.end(), patient->patientID);
+        if (it != ids.end() && *it == patient->patientID)
         {
-            Patient *temp = node->right;
-            delete node;
-            return temp;
+            ids.erase(it);
         }
-        else if (node->right == nullptr)
+        if (ids.empty())
         {
-            Patient *temp = node->left;
-            delete node;
-            return temp;
+            trigramIndex.erase(grams);
         }
-
-        Patient *temp = findMin(node->right);
-        node->patientID = temp->patientID;
-        node->name = temp->name;
-        node->age = temp->age;
-        node->gender = temp->gender;
-        node->address = temp->address;
-        node->phone = temp->phone;
-        node->bloodGroup = temp->bloodGroup;
-        node->medicalHistory = temp->medicalHistory;
-
-        node->right = deleteBST(node->right, temp->patientID);
     }
+    nameByID.erase(patient->patientID);
 
-    return node;
+    for (const std::string &term : historyTerms(patient->medicalHistory))
+    {
+        removeHistoryPosting(term, patient->patientID);
+    }
 }
 
-void PatientManager::inorderTraversal(Patient *node)
+void PatientManager::addHistoryPosting(const std::string &term, int id)
 {
-    if (node != nullptr)
+    HistoryPostings &postings = historyIndex[term];
+    if (postings.count == 0 || id > postings.lastID)
     {
-        inorderTraversal(node->left);
-        std::cout << "\n----------------------------------------\n";
-        std::cout << "Patient ID: " << node->patientID << "\n";
-        std::cout << "Name: " << node->name << "\n";
-        std::cout << "Age: " << node->age << "\n";
-        std::cout << "Gender: " << node->gender << "\n";
-        std::cout << "Address: " << node->address << "\n";
-        std::cout << "Phone: " << node->phone << "\n";
-        std::cout << "Blood Group: " << node->bloodGroup << "\n";
-        std::cout << "Medical History: " << node->medicalHistory << "\n";
-        inorderTraversal(node->right);
+        // Common case (new or loaded-in-order IDs): append one gap
+        appendVarint(postings.bytes, static_cast<unsigned int>(id - postings.lastID));
+        postings.count++;
+        postings.lastID = id;
+        return;
     }
+
+    std::vector<int> ids = decodePostings(postings);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id)
+        return;
+    ids.insert(it, id);
+    encodePostings(postings, ids);
+}
+
+void PatientManager::removeHistoryPosting(const std::string &term, int id)
+{
+    auto entry = historyIndex.find(term);
+    if (entry == historyIndex.end())
+        return;
+
+    std::vector<int> ids = decodePostings(entry->second);
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it == ids.end() || *it != id)
+        return;
+    ids.erase(it);
+
+    if (ids.empty())
+        historyIndex.erase(entry);
+    else
+        encodePostings(entry->second, ids);
+}
+
+std::vector<int> PatientManager::historyPostings(const std::string &term)
+{
+    auto entry = historyIndex.find(term);
+    if (entry == historyIndex.end())
+        return std::vector<int>();
+    return decodePostings(entry->second);
+}
+
+void PatientManager::displayPatient(const Patient &patient)
+{
+    std::cout << "\n----------------------------------------\n";
+    std::cout << "Patient ID: " << patient.patientID << "\n";
+    std::cout << "Name: " << patient.name << "\n";
+    std::cout << "Age: " << patient.age << "\n";
+    std::cout << "Gender: " << patient.gender << "\n";
+    std::cout << "Address: " << patient.address << "\n";
+    std::cout << "Phone: " << patient.phone << "\n";
+    std::cout << "Blood Group: " << patient.bloodGroup << "\n";
+    std::cout << "Medical History: " << patient.medicalHistory << "\n";
 }
 
 void PatientManager::registerPatient()
@@ -132,7 +295,9 @@ void PatientManager::registerPatient()
     clearScreen();
     std::cout << "========== REGISTER NEW PATIENT ==========\n\n";
 
-    int id = generateID("patients.txt");
+    // Next ID after the largest in memory (the data file may lag behind the delta log)
+    Patient *lastPatient = records.last();
+    int id = lastPatient != nullptr ? lastPatient->patientID + 1 : 1;
     std::cout << "Generated Patient ID: " << id << "\n\n";
 
     std::string name = getValidString("Enter Patient Name: ");
@@ -140,11 +305,24 @@ void PatientManager::registerPatient()
     std::string gender = getValidString("Enter Gender (M/F/Other): ");
     std::string address = getValidString("Enter Address: ");
     std::string phone = getValidString("Enter Phone Number: ");
+    std::vector<int> existing = findPatientsByPhone(phone);
+    if (!existing.empty())
+    {
+        std::cout << "Note: this phone number is already registered to patient ID";
+        for (int existingID : existing)
+        {
+            std::cout << " " << existingID;
+        }
+        std::cout << "\n";
+    }
     std::string bloodGroup = getValidString("Enter Blood Group: ");
     std::string medicalHistory = getValidString("Enter Medical History (or 'None'): ");
 
-    Patient *newPatient = new Patient(id, name, age, gender, address, phone, bloodGroup, medicalHistory);
-    root = insertBST(root, newPatient);
+    Patient *newPatient = records.create(id, std::move(name), age, std::move(gender), std::move(address),
+                                         std::move(phone), std::move(bloodGroup), std::move(medicalHistory));
+    newPatient->registrationDate = getCurrentDate();
+    records.insert(newPatient);
+    deltaLog.markDirty(id);
 
     std::cout << "\nPatient registered successfully!\n";
     saveToFile();
@@ -153,7 +331,7 @@ void PatientManager::registerPatient()
 
 void PatientManager::viewPatient(int id)
 {
-    Patient *patient = searchBST(root, id);
+    Patient *patient = records.find(id);
     if (patient != nullptr)
     {
         std::cout << "\n========== PATIENT DETAILS ==========\n";
@@ -165,6 +343,8 @@ void PatientManager::viewPatient(int id)
         std::cout << "Phone: " << patient->phone << "\n";
         std::cout << "Blood Group: " << patient->bloodGroup << "\n";
         std::cout << "Medical History: " << patient->medicalHistory << "\n";
+        if (!patient->registrationDate.empty())
+            std::cout << "Registered: " << patient->registrationDate << "\n";
         std::cout << "=====================================\n";
     }
     else
@@ -177,13 +357,13 @@ void PatientManager::viewAllPatients()
 {
     clearScreen();
     std::cout << "========== ALL PATIENTS ==========\n";
-    if (root == nullptr)
+    if (records.empty())
     {
         std::cout << "No patients registered yet.\n";
     }
     else
     {
-        inorderTraversal(root);
+        records.forEach([this](const Patient &patient) { displayPatient(patient); });
     }
     std::cout << "\n=====================================\n";
     pause();
@@ -191,7 +371,7 @@ void PatientManager::viewAllPatients()
 
 void PatientManager::updatePatient(int id)
 {
-    Patient *patient = searchBST(root, id);
+    Patient *patient = records.find(id);
     if (patient == nullptr)
     {
         std::cout << "\nPatient with ID " << id << " not found!\n";
@@ -205,43 +385,49 @@ void PatientManager::updatePatient(int id)
     viewPatient(id);
     std::cout << "\nEnter new information (press Enter to keep current value):\n\n";
 
-    std::string input;
+    // Collect every answer first; the record is re-indexed once, in update()
+    std::string name, age, gender, address, phone, bloodGroup, medicalHistory;
 
     std::cout << "Name [" << patient->name << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->name = input;
+    std::getline(std::cin, name);
 
     std::cout << "Age [" << patient->age << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->age = std::stoi(input);
+    std::getline(std::cin, age);
 
     std::cout << "Gender [" << patient->gender << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->gender = input;
+    std::getline(std::cin, gender);
 
     std::cout << "Address [" << patient->address << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->address = input;
+    std::getline(std::cin, address);
 
     std::cout << "Phone [" << patient->phone << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->phone = input;
+    std::getline(std::cin, phone);
 
     std::cout << "Blood Group [" << patient->bloodGroup << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->bloodGroup = input;
+    std::getline(std::cin, bloodGroup);
 
     std::cout << "Medical History [" << patient->medicalHistory << "]: ";
-    std::getline(std::cin, input);
-    if (!input.empty())
-        patient->medicalHistory = input;
+    std::getline(std::cin, medicalHistory);
 
+    // Parsed before update() so a bad age cannot leave the record unindexed
+    int newAge = age.empty() ? patient->age : std::stoi(age);
+    records.update(id, [&](Patient &record)
+    {
+        if (!name.empty())
+            record.name = name;
+        record.age = newAge;
+        if (!gender.empty())
+            record.gender = gender;
+        if (!address.empty())
+            record.address = address;
+        if (!phone.empty())
+            record.phone = phone;
+        if (!bloodGroup.empty())
+            record.bloodGroup = bloodGroup;
+        if (!medicalHistory.empty())
+            record.medicalHistory = medicalHistory;
+    });
+    deltaLog.markDirty(id);
     std::cout << "\nPatient information updated successfully!\n";
     saveToFile();
     pause();
@@ -249,7 +435,7 @@ void PatientManager::updatePatient(int id)
 
 void PatientManager::deletePatient(int id)
 {
-    Patient *patient = searchBST(root, id);
+    Patient *patient = records.find(id);
     if (patient == nullptr)
     {
         std::cout << "\nPatient with ID " << id << " not found!\n";
@@ -258,7 +444,8 @@ void PatientManager::deletePatient(int id)
     }
 
     std::cout << "\nDeleting patient: " << patient->name << "\n";
-    root = deleteBST(root, id);
+    records.erase(id);
+    deltaLog.markDeleted(id);
     std::cout << "Patient deleted successfully!\n";
     saveToFile();
     pause();
@@ -266,76 +453,577 @@ void PatientManager::deletePatient(int id)
 
 bool PatientManager::patientExists(int id)
 {
-    return searchBST(root, id) != nullptr;
+    return records.find(id) != nullptr;
 }
 
-void PatientManager::loadFromFile()
+std::vector<int> PatientManager::findPatientsByPhone(const std::string &phone)
+{
+    std::vector<int> ids;
+    auto range = phoneIndex.equal_range(normalizePhone(phone));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        ids.push_back(it->second);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::vector<int> PatientManager::findPatientsByNamePrefix(const std::string &prefix, size_t limit)
+{
+    std::vector<int> ids;
+    std::string key = toLowerCase(prefix);
+    for (auto it = nameIndex.lower_bound({key, 0});
+         it != nameIndex.end() && ids.size() < limit; ++it)
+    {
+        if (it->first.compare(0, key.size(), key) != 0)
+            break;
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+std::vector<int> PatientManager::findPatientsByBloodGroup(const std::string &bloodGroup)
+{
+    auto postings = bloodGroupIndex.find(normalizeCode(bloodGroup));
+    if (postings == bloodGroupIndex.end())
+    {
+        return std::vector<int>();
+    }
+    return std::vector<int>(postings->second.begin(), postings->second.end());
+}
+
+// Top-k patients whose name is within maxDistance edits of the query
+// (default scales with name length), as (patient ID, distance) pairs.
+// A name within k edits shares at least T = |grams| - 3k of the query's
+// distinct trigrams, so it must appear in one of the |grams| - T + 1
+// shortest postings lists. Those candidates are then counted against the
+// remaining (sorted) lists and only ones reaching T are compared in full.
+std::vector<std::pair<int, int>> PatientManager::findSimilarPatients(const std::string &name, size_t k,
+                                                                     int maxDistance)
+{
+    std::string key = toLowerCase(name);
+    if (maxDistance < 0)
+    {
+        maxDistance = 1 + static_cast<int>(key.size()) / 8;
+    }
+
+    std::vector<std::pair<int, int>> ranked; // (distance, patient ID)
+    auto consider = [&](int id, const std::string &candidate)
+    {
+        int lengthGap = static_cast<int>(candidate.size()) - static_cast<int>(key.size());
+        if (std::abs(lengthGap) > maxDistance)
+            return;
+        int distance = editDistance(key, candidate);
+        if (distance <= maxDistance)
+            ranked.push_back({distance, id});
+    };
+
+    std::vector<unsigned int> grams = nameTrigrams(key);
+    int threshold = static_cast<int>(grams.size()) - 3 * maxDistance;
+    if (threshold <= 0)
+    {
+        // Query too short for the trigram filter to prune anything
+        for (const auto &entry : nameByID)
+        {
+            consider(entry.first, entry.second);
+        }
+    }
+    else
+    {
+        std::vector<const std::vector<int> *> postings;
+        for (unsigned int gram : grams)
+        {
+            auto it = trigramIndex.find(gram);
+            if (it != trigramIndex.end())
+                postings.push_back(&it->second);
+        }
+
+        // Grams missing from the index count as empty lists
+        size_t needed = grams.size() - threshold + 1;
+        size_t missing = grams.size() - postings.size();
+        size_t lists = needed > missing ? needed - missing : 0;
+        std::sort(postings.begin(), postings.end(),
+                  [](const std::vector<int> *a, const std::vector<int> *b)
+                  { return a->size() < b->size(); });
+
+        std::vector<int> merged;
+        for (size_t i = 0; i < lists && i < postings.size(); i++)
+        {
+            merged.insert(merged.end(), postings[i]->begin(), postings[i]->end());
+        }
+        std::sort(merged.begin(), merged.end());
+
+        std::vector<int> candidates;
+        std::vector<int> shared;
+        for (size_t i = 0; i < merged.size(); i++)
+        {
+            if (candidates.empty() || candidates.back() != merged[i])
+            {
+                candidates.push_back(merged[i]);
+                shared.push_back(0);
+            }
+            shared.back()++;
+        }
+
+        for (size_t i = lists; i < postings.size() && !candidates.empty(); i++)
+        {
+            auto position = postings[i]->begin();
+            for (size_t c = 0; c < candidates.size(); c++)
+            {
+                position = std::lower_bound(position, postings[i]->end(), candidates[c]);
+                if (position == postings[i]->end())
+                    break;
+                if (*position == candidates[c])
+                    shared[c]++;
+            }
+        }
+
+        for (size_t c = 0; c < candidates.size(); c++)
+        {
+            if (shared[c] >= threshold)
+                consider(candidates[c], nameByID[candidates[c]]);
+        }
+    }
+
+    size_t count = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+
+    std::vector<std::pair<int, int>> matches;
+    for (size_t i = 0; i < count; i++)
+    {
+        matches.push_back({ranked[i].second, ranked[i].first});
+    }
+    return matches;
+}
+
+void PatientManager::fuzzySearchPatients(const std::string &name)
 {
-    std::ifstream file("patients.txt");
-    if (!file.is_open())
+    std::vector<std::pair<int, int>> matches = findSimilarPatients(name);
+    if (matches.empty())
     {
+        std::cout << "\nNo patients with a name similar to '" << name << "'.\n";
         return;
     }
 
-    std::string line;
-    while (std::getline(file, line))
+    std::cout << "\n========== SIMILAR PATIENTS ==========\n";
+    for (const auto &match : matches)
     {
-        if (line.empty())
-            continue;
+        Patient *patient = records.find(match.first);
+        std::cout << patient->patientID << ". " << patient->name
+                  << " (Phone: " << patient->phone
+                  << ", Edits: " << match.second << ")\n";
+    }
+    std::cout << "======================================\n";
+}
 
-        std::istringstream iss(line);
-        int id, age;
-        std::string name, gender, address, phone, bloodGroup, medicalHistory;
+// Batch job: every pair of patients whose names are within maxDistance edits,
+// written to duplicate_patients.txt for review
+void PatientManager::findDuplicatePatients(int maxDistance)
+{
+    std::vector<int> ids;
+    ids.reserve(nameByID.size());
+    for (const auto &entry : nameByID)
+    {
+        ids.push_back(entry.first);
+    }
+    std::sort(ids.begin(), ids.end());
 
-        if (iss >> id >> age)
+    std::ofstream file("duplicate_patients.txt");
+    size_t pairs = 0;
+    std::cout << "\n========== POSSIBLE DUPLICATES ==========\n";
+    for (int id : ids)
+    {
+        std::vector<std::pair<int, int>> matches =
+            findSimilarPatients(nameByID[id], nameByID.size(), maxDistance);
+        for (const auto &match : matches)
         {
-            std::getline(iss, name, '|');
-            std::getline(iss, name, '|');
-            std::getline(iss, gender, '|');
-            std::getline(iss, address, '|');
-            std::getline(iss, phone, '|');
-            std::getline(iss, bloodGroup, '|');
-            std::getline(iss, medicalHistory, '|');
-
-            if (!name.empty() && name[0] == ' ')
-                name = name.substr(1);
-
-            Patient *newPatient = new Patient(id, name, age, gender, address, phone, bloodGroup, medicalHistory);
-            root = insertBST(root, newPatient);
+            if (match.first <= id)
+                continue;
+
+            Patient *first = records.find(id);
+            Patient *second = records.find(match.first);
+            bool samePhone = normalizePhone(first->phone) == normalizePhone(second->phone);
+
+            file << id << " " << match.first << " " << match.second << " |" << first->name
+                 << "|" << second->name << "|" << (samePhone ? "same phone" : "") << "|\n";
+            if (pairs < 20)
+            {
+                std::cout << id << ". " << first->name << " <-> " << match.first << ". "
+                          << second->name << " (Edits: " << match.second
+                          << (samePhone ? ", same phone" : "") << ")\n";
+            }
+            pairs++;
         }
     }
     file.close();
+
+    if (pairs > 20)
+    {
+        std::cout << "... and " << pairs - 20 << " more\n";
+    }
+    std::cout << "Pairs found: " << pairs << " (full list in duplicate_patients.txt)\n";
+    std::cout << "=========================================\n";
 }
 
-void PatientManager::saveToFileHelper(Patient *node, std::ofstream &file)
+// Boolean query over medical histories, e.g. "diabetes AND hypertension OR
+// asthma". AND binds tighter than OR; adjacent terms without an operator
+// are ANDed. Returns matching patient IDs in ascending order.
+std::vector<int> PatientManager::searchMedicalHistory(const std::string &query)
 {
-    if (node != nullptr)
+    // Split into OR clauses of AND terms
+    std::vector<std::vector<std::string>> clauses(1);
+    std::istringstream iss(query);
+    std::string word;
+    while (iss >> word)
+    {
+        std::string lowered = toLowerCase(word);
+        if (lowered == "or")
+        {
+            if (!clauses.back().empty())
+                clauses.emplace_back();
+            continue;
+        }
+        if (lowered == "and")
+            continue;
+        for (const std::string &term : historyTerms(word))
+        {
+            clauses.back().push_back(term);
+        }
+    }
+
+    std::vector<int> result;
+    for (const auto &clause : clauses)
     {
-        saveToFileHelper(node->left, file);
-        file << node->patientID << " " << node->age << " |" << node->name
-             << "|" << node->gender << "|" << node->address << "|"
-             << node->phone << "|" << node->bloodGroup << "|"
-             << node->medicalHistory << "|\n";
-        saveToFileHelper(node->right, file);
+        if (clause.empty())
+            continue;
+
+        // Intersect starting from the rarest term
+        std::vector<std::vector<int>> lists;
+        for (const std::string &term : clause)
+        {
+            lists.push_back(historyPostings(term));
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const std::vector<int> &a, const std::vector<int> &b)
+                  { return a.size() < b.size(); });
+
+        std::vector<int> matches = lists.front();
+        for (size_t i = 1; i < lists.size() && !matches.empty(); i++)
+        {
+            matches = gallopingIntersect(matches, lists[i]);
+        }
+
+        std::vector<int> merged;
+        std::set_union(result.begin(), result.end(), matches.begin(), matches.end(),
+                       std::back_inserter(merged));
+        result.swap(merged);
     }
+    return result;
 }
 
-void PatientManager::saveToFile()
+void PatientManager::viewMedicalHistorySearch(const std::string &query)
 {
-    std::ofstream file("patients.txt");
-    if (file.is_open())
+    std::vector<int> ids = searchMedicalHistory(query);
+    if (ids.empty())
     {
-        saveToFileHelper(root, file);
-        file.close();
+        std::cout << "\nNo patients match '" << query << "'.\n";
+        return;
     }
+    printPatientList(ids);
 }
 
-void PatientManager::clearTree(Patient *node)
+void PatientManager::filterPatients(int minAge, int maxAge, const std::string &bloodGroup)
 {
-    if (node != nullptr)
+    std::vector<size_t> rows = columns.filterByAgeAndBloodGroup(minAge, maxAge, bloodGroup);
+
+    std::cout << "\n========== FILTERED PATIENTS ==========\n";
+    size_t shown = std::min<size_t>(rows.size(), 50);
+    for (size_t i = 0; i < shown; i++)
     {
-        clearTree(node->left);
-        clearTree(node->right);
-        delete node;
+        size_t row = rows[i];
+        const Patient *patient = records.find(columns.id(row));
+        std::cout << patient->patientID << ". " << patient->name
+                  << " (Age: " << columns.age(row)
+                  << ", Blood Group: " << columns.bloodGroup(row) << ")\n";
     }
+    if (rows.size() > shown)
+    {
+        std::cout << "... and " << rows.size() - shown << " more\n";
+    }
+    std::cout << "Total: " << rows.size() << "\n";
+    std::cout << "=======================================\n";
+}
+
+void PatientManager::runCohortQuery(const CohortFilter &filter, CohortGroup group,
+                                    const std::vector<PatientSet> &doctorGroups)
+{
+    auto start = std::chrono::steady_clock::now();
+    SelectionBitmap selection = columns.select(filter);
+    std::vector<CohortGroupResult> groups = group == GROUP_DOCTOR
+                                                ? columns.groupBySets(selection, doctorGroups, "Unassigned")
+                                                : columns.groupBy(selection, group);
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\n========== COHORT QUERY ==========\n";
+    std::cout << "Matching patients: " << selection.count() << " of " << columns.size() << "\n";
+    if (group != GROUP_NONE)
+    {
+        for (const CohortGroupResult &result : groups)
+        {
+            std::cout << "  " << result.label << ": " << result.count
+                      << " (Average age: " << std::fixed << std::setprecision(1) << result.averageAge << ")\n";
+        }
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::cout << "Query time: " << elapsed << " us\n";
+    std::cout << "==================================\n";
+}
+
+// Scan throughput on a scratch column store (patients.txt is not touched)
+void PatientManager::runCohortBenchmark(int rows)
+{
+    typedef std::chrono::steady_clock Clock;
+    const char *genderValues[] = {"M", "F", "Other"};
+    const char *bloodGroupValues[] = {"O+", "O-", "A+", "A-", "B+", "B-", "AB+", "AB-"};
+    std::mt19937 rng(42);
+
+    PatientColumns scratch;
+    Patient row(0, "Benchmark Patient", 0, "", "Benchmark Street", "0300", "", "None");
+    Clock::time_point start = Clock::now();
+    for (int i = 1; i <= rows; i++)
+    {
+        row.patientID = i;
+        row.age = static_cast<int>(rng() % 100);
+        row.gender = genderValues[rng() % 3];
+        row.bloodGroup = bloodGroupValues[rng() % 8];
+        scratch.upsert(&row);
+    }
+    double buildTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    CohortFilter filter;
+    filter.minAge = 61;
+    filter.gender = "F";
+    filter.bloodGroup = "O-";
+
+    // Repeat until at least 10M rows have been scanned for a stable rate
+    int passes = std::max(1, 10000000 / std::max(1, rows));
+    size_t matched = 0;
+    start = Clock::now();
+    for (int pass = 0; pass < passes; pass++)
+    {
+        matched = scratch.select(filter).count();
+    }
+    double scanTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    std::vector<CohortGroupResult> groups = scratch.groupBy(scratch.select(CohortFilter()), GROUP_BLOOD_GROUP);
+    double groupTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double rowsPerSecond = static_cast<double>(rows) * passes / scanTime;
+    std::cout << "\n========== COHORT BENCHMARK ==========\n";
+    std::cout << "Rows: " << rows << " (built in " << buildTime << " s)\n";
+    std::cout << "Filter age > 60 AND gender F AND blood group O-: " << matched << " rows\n";
+    std::cout << "Scan rate: " << static_cast<long long>(rowsPerSecond) << " rows/s ("
+              << passes << " passes)\n";
+    std::cout << "Group by blood group over all rows: " << groups.size() << " groups in "
+              << groupTime << " s\n";
+    std::cout << "======================================\n";
+}
+
+// Parse-and-store cost per record on a scratch store (patients.txt is not
+// touched and the secondary indexes are not built)
+void PatientManager::runLoadBenchmark(int rows)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::vector<std::string> lines;
+    lines.reserve(rows > 0 ? rows : 0);
+    for (int i = 1; i <= rows; i++)
+    {
+        std::ostringstream line;
+        line << i << " " << (i % 90) << " |Benchmark Patient " << i << "|M|House " << i
+             << ", Benchmark Street, Lahore|0300" << std::setw(7) << std::setfill('0') << i
+             << "|O+|Seasonal allergies, no chronic conditions|01/01/2024|";
+        lines.push_back(line.str());
+    }
+
+    PatientStore scratch;
+    unsigned long long allocationsBefore = heapAllocationCount();
+    Clock::time_point start = Clock::now();
+    for (const std::string &line : lines)
+    {
+        Patient *patient = parseRecord(line, scratch);
+        if (patient != nullptr && !scratch.insert(patient))
+            scratch.destroy(patient);
+    }
+    double loadTime = std::chrono::duration<double>(Clock::now() - start).count();
+    unsigned long long allocations = heapAllocationCount() - allocationsBefore;
+
+    std::cout << "\n========== LOAD BENCHMARK ==========\n";
+    std::cout << "Records: " << scratch.size() << " parsed and stored in " << loadTime << " s\n";
+    if (rows > 0)
+    {
+        std::cout << "Rate: " << static_cast<long long>(rows / loadTime) << " records/s\n";
+        if (heapAllocationsCounted())
+            std::cout << "Allocations per record: " << static_cast<double>(allocations) / rows << "\n";
+        else
+            std::cout << "Allocations per record: not counted (build with -DHMS_COUNT_ALLOCATIONS)\n";
+    }
+    std::cout << "Node pool: " << scratch.nodePool().slabCount() << " slabs, tree height "
+              << scratch.height() << "\n";
+    std::cout << "====================================\n";
+}
+
+// Approximate heap footprint of the stored records (pool slots plus string
+// buffers that do not fit the small-string buffer)
+size_t PatientManager::treeMemory()
+{
+    size_t bytes = records.nodePool().bytesReserved();
+    records.forEach([&bytes](const Patient &patient)
+    {
+        const std::string *fields[] = {&patient.name, &patient.gender, &patient.address, &patient.phone,
+                                       &patient.bloodGroup, &patient.medicalHistory};
+        for (const std::string *field : fields)
+        {
+            if (field->capacity() > std::string().capacity())
+            {
+                bytes += field->capacity() + 1;
+            }
+        }
+    });
+    return bytes;
+}
+
+void PatientManager::viewStorageStatistics()
+{
+    std::cout << "\n========== PATIENT STORAGE ==========\n";
+    size_t recordBytes = treeMemory();
+    size_t columnBytes = columns.memoryUsage();
+    std::cout << "Patients: " << columns.size() << "\n";
+    std::cout << "Record store: ~" << recordBytes / 1024 << " KB (tree height "
+              << records.height() << ")\n";
+    std::cout << "Scan columns: ~" << columnBytes / 1024 << " KB (fixed-width fields only)\n";
+    std::cout << "Total: ~" << (recordBytes + columnBytes) / 1024 << " KB";
+    if (!records.empty())
+    {
+        std::cout << " (~" << (recordBytes + columnBytes) / records.size() << " bytes per patient)";
+    }
+    std::cout << "\n";
+    std::cout << "Node pool: " << records.nodePool().liveCount() << " / "
+              << records.nodePool().slotCapacity() << " slots in "
+              << records.nodePool().slabCount() << " slabs\n";
+    if (loadedRecords > 0)
+    {
+        std::cout << "Last load: " << loadedRecords << " records in " << loadSeconds << " s";
+        if (heapAllocationsCounted())
+        {
+            std::cout << ", " << static_cast<double>(loadAllocations) / loadedRecords
+                      << " allocations per record (with indexes)";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "=====================================\n";
+}
+
+void PatientManager::printPatientList(const std::vector<int> &ids)
+{
+    std::cout << "\n========== MATCHING PATIENTS ==========\n";
+    for (int id : ids)
+    {
+        Patient *patient = records.find(id);
+        std::cout << patient->patientID << ". " << patient->name
+                  << " (Phone: " << patient->phone
+                  << ", Blood Group: " << patient->bloodGroup << ")\n";
+    }
+    std::cout << "Total: " << ids.size() << "\n";
+    std::cout << "=======================================\n";
+}
+
+void PatientManager::searchPatientByPhone(const std::string &phone)
+{
+    std::vector<int> ids = findPatientsByPhone(phone);
+    if (ids.empty())
+    {
+        std::cout << "\nNo patient registered with phone " << phone << "!\n";
+        return;
+    }
+    if (ids.size() == 1)
+    {
+        viewPatient(ids.front());
+        return;
+    }
+    printPatientList(ids);
+}
+
+void PatientManager::searchPatientByName(const std::string &prefix)
+{
+    std::vector<int> ids = findPatientsByNamePrefix(prefix);
+    if (ids.empty())
+    {
+        std::cout << "\nNo patients with a name starting with '" << prefix << "'.\n";
+        return;
+    }
+    printPatientList(ids);
+}
+
+void PatientManager::viewPatientsByBloodGroup(const std::string &bloodGroup)
+{
+    std::vector<int> ids = findPatientsByBloodGroup(bloodGroup);
+    if (ids.empty())
+    {
+        std::cout << "\nNo patients with blood group " << bloodGroup << ".\n";
+        return;
+    }
+    printPatientList(ids);
+}
+
+// Fields are read once and moved into the new record, so a long field costs
+// a single allocation
+Patient *PatientManager::parseRecord(const std::string &line, PatientStore &store)
+{
+    Patient *patient = store.create(0, "", 0, "", "", "", "", "");
+    if (!PatientFormat::read(line, *patient))
+    {
+        store.destroy(patient);
+        return nullptr;
+    }
+    return patient;
+}
+
+// Load the last full snapshot, then replay the delta log over it: record
+// lines replace or add a patient, "-<id>" lines delete one
+void PatientManager::loadFromFile()
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    unsigned long long allocationsBefore = heapAllocationCount();
+
+    deltaLog.replay(
+        [this](const std::string &line, bool fromDelta)
+        {
+            Patient *newPatient = parseRecord(line, records);
+            if (newPatient == nullptr)
+                return;
+            if (fromDelta)
+                records.erase(newPatient->patientID);
+            if (!records.insert(newPatient))
+                records.destroy(newPatient);
+        },
+        [this](int id) { records.erase(id); });
+
+    loadedRecords = records.size();
+    loadAllocations = heapAllocationCount() - allocationsBefore;
+    loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Persist only the records changed since the last save by appending them to
+// patients_delta.txt; the log is folded into patients.txt once it outgrows
+// the record count
+void PatientManager::saveToFile()
+{
+    deltaLog.save();
+}
+
+void PatientManager::compactFile()
+{
+    deltaLog.compact();
 }
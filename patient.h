@@ -3,6 +3,12 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include "patientColumns.h"
+#include "indexedStore.h"
+#include "deltaLog.h"
 
 struct Patient {
     int patientID;
@@ -13,27 +19,65 @@ struct Patient {
     std::string phone;
     std::string bloodGroup;
     std::string medicalHistory;
-    
-    Patient* left;
-    Patient* right;
-    
+    std::string registrationDate; // DD/MM/YYYY, empty for records saved before it was tracked
 
     Patient(int id, std::string n, int a, std::string g, std::string addr, 
             std::string ph, std::string bg, std::string mh);
 };
 
+// Compressed postings for one medical-history term: sorted patient IDs
+// stored as varint-encoded gaps
+struct HistoryPostings {
+    std::vector<unsigned char> bytes;
+    int count;
+    int lastID;
+
+    HistoryPostings();
+};
+
+typedef IndexedStore<Patient, int, &Patient::patientID> PatientStore;
+
 class PatientManager {
 private:
-    Patient* root;
+    PatientStore records;
+    
+    // Secondary indexes (keyed back to records by patient ID), attached to
+    // the store so insert, erase and update keep them current
+    std::unordered_multimap<std::string, int> phoneIndex;        // normalized phone
+    std::set<std::pair<std::string, int>> nameIndex;             // lowercase name, prefix search
+    std::unordered_map<std::string, std::set<int>> bloodGroupIndex; // postings per blood group
+    
+    // Fuzzy name search: trigram postings shortlist candidates, which are then
+    // ranked by edit distance against the lowercase name kept in nameByID
+    std::unordered_map<unsigned int, std::vector<int>> trigramIndex;
+    std::unordered_map<int, std::string> nameByID;
+    
+    // Inverted index over medicalHistory terms
+    std::unordered_map<std::string, HistoryPostings> historyIndex;
+    
+    // Fixed-width scan columns for filters and aggregates; names and other
+    // free text are read back from the record store by ID
+    PatientColumns columns;
+    
+    // Incremental persistence: changed records are appended to
+    // patients_delta.txt and folded into patients.txt on compaction
+    DeltaLog<PatientStore> deltaLog;
+    
+    // Cost of the last loadFromFile(), shown with the storage statistics
+    size_t loadedRecords;
+    unsigned long long loadAllocations;
+    double loadSeconds;
     
 
-    Patient* insertBST(Patient* node, Patient* newPatient);
-    Patient* searchBST(Patient* node, int id);
-    Patient* deleteBST(Patient* node, int id);
-    Patient* findMin(Patient* node);
-    void inorderTraversal(Patient* node);
-    void saveToFileHelper(Patient* node, std::ofstream& file);
-    void clearTree(Patient* node);
+    void displayPatient(const Patient& patient);
+    void indexPatient(Patient* patient);
+    void unindexPatient(Patient* patient);
+    void printPatientList(const std::vector<int>& ids);
+    void addHistoryPosting(const std::string& term, int id);
+    void removeHistoryPosting(const std::string& term, int id);
+    std::vector<int> historyPostings(const std::string& term);
+    size_t treeMemory();
+    Patient* parseRecord(const std::string& line, PatientStore& store);
     
 public:
     PatientManager();
@@ -47,8 +91,32 @@ public:
 
     void loadFromFile();
     void saveToFile();
+    void compactFile();
 
     bool patientExists(int id);
+
+    // Lookups through the secondary indexes
+    std::vector<int> findPatientsByPhone(const std::string& phone);
+    std::vector<int> findPatientsByNamePrefix(const std::string& prefix, size_t limit = 20);
+    std::vector<int> findPatientsByBloodGroup(const std::string& bloodGroup);
+    std::vector<std::pair<int, int>> findSimilarPatients(const std::string& name, size_t k = 10,
+                                                         int maxDistance = -1);
+    void searchPatientByPhone(const std::string& phone);
+    void searchPatientByName(const std::string& prefix);
+    void viewPatientsByBloodGroup(const std::string& bloodGroup);
+    void fuzzySearchPatients(const std::string& name);
+    void findDuplicatePatients(int maxDistance);
+    std::vector<int> searchMedicalHistory(const std::string& query);
+    void viewMedicalHistorySearch(const std::string& query);
+    void filterPatients(int minAge, int maxAge, const std::string& bloodGroup);
+    void viewStorageStatistics();
+
+    // Cohort queries over the columnar store; doctor assignments live with
+    // DoctorManager and come in as patient sets (GROUP_DOCTOR groups by them)
+    void runCohortQuery(const CohortFilter& filter, CohortGroup group,
+                        const std::vector<PatientSet>& doctorGroups = std::vector<PatientSet>());
+    void runCohortBenchmark(int rows);
+    void runLoadBenchmark(int rows);
 };
 
 #endif
@@ -0,0 +1,445 @@
+#include "patientColumns.h"
+#include "patient.h"
+#include "utils.h"
+#include <algorithm>
+#include <climits>
+
+unsigned char StringInterner::intern(const std::string &value)
+{
+    auto it = codes.find(value);
+    if (it != codes.end())
+    {
+        return it->second;
+    }
+
+    // Codes are one byte; everything past the 255th value shares "OTHER"
+    if (values.size() >= 255)
+    {
+        if (values.size() == 255)
+        {
+            values.push_back("OTHER");
+        }
+        return 255;
+    }
+
+    unsigned char code = static_cast<unsigned char>(values.size());
+    values.push_back(value);
+    codes[value] = code;
+    return code;
+}
+
+int StringInterner::find(const std::string &value) const
+{
+    auto it = codes.find(value);
+    return it != codes.end() ? it->second : NOT_FOUND;
+}
+
+const std::string &StringInterner::value(unsigned char code) const
+{
+    return values[code];
+}
+
+size_t StringInterner::size() const
+{
+    return values.size();
+}
+
+SelectionBitmap::SelectionBitmap(size_t rowCount, bool selected)
+    : words((rowCount + 63) / 64, selected ? ~0ULL : 0ULL), rows(rowCount)
+{
+    // Clear the padding bits past the last row
+    if (selected && rowCount % 64 != 0)
+    {
+        words.back() = (1ULL << (rowCount % 64)) - 1;
+    }
+}
+
+size_t SelectionBitmap::size() const
+{
+    return rows;
+}
+
+size_t SelectionBitmap::wordCount() const
+{
+    return words.size();
+}
+
+unsigned long long SelectionBitmap::word(size_t index) const
+{
+    return words[index];
+}
+
+void SelectionBitmap::intersect(size_t index, unsigned long long bits)
+{
+    words[index] &= bits;
+}
+
+void SelectionBitmap::intersect(const SelectionBitmap &other)
+{
+    for (size_t w = 0; w < words.size(); w++)
+    {
+        words[w] &= w < other.words.size() ? other.words[w] : 0ULL;
+    }
+}
+
+void SelectionBitmap::set(size_t row)
+{
+    words[row / 64] |= 1ULL << (row % 64);
+}
+
+bool SelectionBitmap::test(size_t row) const
+{
+    return (words[row / 64] >> (row % 64)) & 1ULL;
+}
+
+size_t SelectionBitmap::count() const
+{
+    size_t total = 0;
+    for (unsigned long long bits : words)
+    {
+        total += static_cast<size_t>(__builtin_popcountll(bits));
+    }
+    return total;
+}
+
+CohortFilter::CohortFilter()
+    : minAge(0), maxAge(1000), registeredFrom(-1), registeredTo(-1), byPatients(false) {}
+
+void PatientColumns::upsert(const Patient *patient)
+{
+    auto it = rowByID.find(patient->patientID);
+    size_t row;
+    if (it == rowByID.end())
+    {
+        row = ids.size();
+        rowByID[patient->patientID] = row;
+        ids.push_back(patient->patientID);
+        ages.push_back(0);
+        genderCodes.push_back(0);
+        bloodGroupCodes.push_back(0);
+        registrationDays.push_back(-1);
+    }
+    else
+    {
+        row = it->second;
+    }
+
+    ages[row] = patient->age;
+    genderCodes[row] = genders.intern(normalizeCode(patient->gender));
+    bloodGroupCodes[row] = bloodGroups.intern(normalizeCode(patient->bloodGroup));
+    registrationDays[row] = dateToDays(patient->registrationDate);
+}
+
+void PatientColumns::remove(int id)
+{
+    auto it = rowByID.find(id);
+    if (it == rowByID.end())
+    {
+        return;
+    }
+
+    size_t row = it->second;
+    size_t last = ids.size() - 1;
+    rowByID.erase(it);
+
+    if (row != last)
+    {
+        ids[row] = ids[last];
+        ages[row] = ages[last];
+        genderCodes[row] = genderCodes[last];
+        bloodGroupCodes[row] = bloodGroupCodes[last];
+        registrationDays[row] = registrationDays[last];
+        rowByID[ids[row]] = row;
+    }
+
+    ids.pop_back();
+    ages.pop_back();
+    genderCodes.pop_back();
+    bloodGroupCodes.pop_back();
+    registrationDays.pop_back();
+}
+
+void PatientColumns::clear()
+{
+    ids.clear();
+    ages.clear();
+    genderCodes.clear();
+    bloodGroupCodes.clear();
+    registrationDays.clear();
+    rowByID.clear();
+}
+
+size_t PatientColumns::size() const
+{
+    return ids.size();
+}
+
+int PatientColumns::id(size_t row) const
+{
+    return ids[row];
+}
+
+int PatientColumns::age(size_t row) const
+{
+    return ages[row];
+}
+
+const std::string &PatientColumns::gender(size_t row) const
+{
+    return genders.value(genderCodes[row]);
+}
+
+const std::string &PatientColumns::bloodGroup(size_t row) const
+{
+    return bloodGroups.value(bloodGroupCodes[row]);
+}
+
+// Branch-free scans: every row index is written and the output cursor only
+// advances on a match, so the predicate loop can be vectorized
+std::vector<size_t> PatientColumns::filterByAgeAndBloodGroup(int minAge, int maxAge,
+                                                             const std::string &bloodGroup) const
+{
+    std::vector<size_t> rows(ids.size() + 1);
+    size_t count = 0;
+
+    if (bloodGroup.empty())
+    {
+        for (size_t row = 0; row < ids.size(); row++)
+        {
+            rows[count] = row;
+            count += (ages[row] >= minAge) & (ages[row] <= maxAge);
+        }
+    }
+    else
+    {
+        int code = bloodGroups.find(normalizeCode(bloodGroup));
+        if (code == StringInterner::NOT_FOUND)
+        {
+            return std::vector<size_t>();
+        }
+        unsigned char wanted = static_cast<unsigned char>(code);
+        for (size_t row = 0; row < ids.size(); row++)
+        {
+            rows[count] = row;
+            count += (ages[row] >= minAge) & (ages[row] <= maxAge) & (bloodGroupCodes[row] == wanted);
+        }
+    }
+
+    rows.resize(count);
+    return rows;
+}
+
+// Evaluate a row predicate 64 rows at a time into bitmap words. The inner
+// loop is branch-free so the compiler can vectorize it; words that are
+// already empty are skipped.
+template <typename Predicate>
+void PatientColumns::applyPredicate(SelectionBitmap &selection, Predicate matches) const
+{
+    size_t rowCount = ids.size();
+    for (size_t w = 0; w < selection.wordCount(); w++)
+    {
+        if (selection.word(w) == 0)
+            continue;
+
+        size_t base = w * 64;
+        size_t end = std::min<size_t>(64, rowCount - base);
+        unsigned long long bits = 0;
+        for (size_t i = 0; i < end; i++)
+        {
+            bits |= static_cast<unsigned long long>(matches(base + i)) << i;
+        }
+        selection.intersect(w, bits);
+    }
+}
+
+SelectionBitmap PatientColumns::select(const CohortFilter &filter) const
+{
+    SelectionBitmap selection(ids.size());
+    const int *age = ages.data();
+    const unsigned char *genderCode = genderCodes.data();
+    const unsigned char *bloodCode = bloodGroupCodes.data();
+    const int *registered = registrationDays.data();
+
+    int minAge = filter.minAge;
+    int maxAge = filter.maxAge;
+    applyPredicate(selection, [age, minAge, maxAge](size_t row)
+                   { return (age[row] >= minAge) & (age[row] <= maxAge); });
+
+    if (!filter.gender.empty())
+    {
+        int code = genders.find(normalizeCode(filter.gender));
+        if (code == StringInterner::NOT_FOUND)
+            return SelectionBitmap(ids.size(), false);
+        unsigned char wanted = static_cast<unsigned char>(code);
+        applyPredicate(selection, [genderCode, wanted](size_t row)
+                       { return genderCode[row] == wanted; });
+    }
+
+    if (!filter.bloodGroup.empty())
+    {
+        int code = bloodGroups.find(normalizeCode(filter.bloodGroup));
+        if (code == StringInterner::NOT_FOUND)
+            return SelectionBitmap(ids.size(), false);
+        unsigned char wanted = static_cast<unsigned char>(code);
+        applyPredicate(selection, [bloodCode, wanted](size_t row)
+                       { return bloodCode[row] == wanted; });
+    }
+
+    if (filter.registeredFrom >= 0 || filter.registeredTo >= 0)
+    {
+        int from = filter.registeredFrom >= 0 ? filter.registeredFrom : 0;
+        int to = filter.registeredTo >= 0 ? filter.registeredTo : INT_MAX;
+        applyPredicate(selection, [registered, from, to](size_t row)
+                       { return (registered[row] >= from) & (registered[row] <= to); });
+    }
+
+    if (filter.byPatients)
+    {
+        selection.intersect(rowsOf(filter.patientIDs));
+    }
+
+    return selection;
+}
+
+// Bitmap of the rows holding the given patients (unknown IDs are ignored)
+SelectionBitmap PatientColumns::rowsOf(const std::vector<int> &patientIDs) const
+{
+    SelectionBitmap rows(ids.size(), false);
+    for (int patientID : patientIDs)
+    {
+        auto it = rowByID.find(patientID);
+        if (it != rowByID.end())
+        {
+            rows.set(it->second);
+        }
+    }
+    return rows;
+}
+
+// Count and average age of the selected rows per group, largest groups first
+std::vector<CohortGroupResult> PatientColumns::groupBy(const SelectionBitmap &selection, CohortGroup group) const
+{
+    std::unordered_map<int, std::pair<size_t, long long>> totals; // key -> (count, sum of ages)
+
+    for (size_t w = 0; w < selection.wordCount(); w++)
+    {
+        unsigned long long bits = selection.word(w);
+        while (bits != 0)
+        {
+            size_t row = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+
+            int key = 0;
+            switch (group)
+            {
+            case GROUP_GENDER:
+                key = genderCodes[row];
+                break;
+            case GROUP_BLOOD_GROUP:
+                key = bloodGroupCodes[row];
+                break;
+            case GROUP_AGE_BAND:
+                key = ages[row] / 10;
+                break;
+            case GROUP_DOCTOR: // Many-to-many, see groupBySets()
+            case GROUP_NONE:
+                break;
+            }
+
+            std::pair<size_t, long long> &total = totals[key];
+            total.first++;
+            total.second += ages[row];
+        }
+    }
+
+    std::vector<CohortGroupResult> results;
+    for (const auto &entry : totals)
+    {
+        CohortGroupResult result;
+        switch (group)
+        {
+        case GROUP_GENDER:
+            result.label = genders.value(static_cast<unsigned char>(entry.first));
+            break;
+        case GROUP_BLOOD_GROUP:
+            result.label = bloodGroups.value(static_cast<unsigned char>(entry.first));
+            break;
+        case GROUP_AGE_BAND:
+            result.label = std::to_string(entry.first * 10) + "-" + std::to_string(entry.first * 10 + 9);
+            break;
+        case GROUP_DOCTOR:
+        case GROUP_NONE:
+            result.label = "All";
+            break;
+        }
+        result.count = entry.second.first;
+        result.averageAge = static_cast<double>(entry.second.second) / entry.second.first;
+        results.push_back(result);
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const CohortGroupResult &a, const CohortGroupResult &b)
+              { return a.count != b.count ? a.count > b.count : a.label < b.label; });
+    return results;
+}
+
+// Count and average age of the selected rows in each set. A row may fall in
+// several sets; selected rows in none of them are reported under otherLabel.
+std::vector<CohortGroupResult> PatientColumns::groupBySets(const SelectionBitmap &selection,
+                                                          const std::vector<PatientSet> &sets,
+                                                          const std::string &otherLabel) const
+{
+    std::vector<CohortGroupResult> results;
+    SelectionBitmap covered(ids.size(), false);
+
+    for (const PatientSet &patientSet : sets)
+    {
+        size_t count = 0;
+        long long ageSum = 0;
+        for (int patientID : patientSet.patientIDs)
+        {
+            auto it = rowByID.find(patientID);
+            if (it == rowByID.end() || !selection.test(it->second))
+                continue;
+            count++;
+            ageSum += ages[it->second];
+            covered.set(it->second);
+        }
+        if (count > 0)
+        {
+            results.push_back(CohortGroupResult{patientSet.label, count, static_cast<double>(ageSum) / count});
+        }
+    }
+
+    size_t otherCount = 0;
+    long long otherAgeSum = 0;
+    for (size_t w = 0; w < selection.wordCount(); w++)
+    {
+        unsigned long long bits = selection.word(w) & ~covered.word(w);
+        while (bits != 0)
+        {
+            size_t row = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            otherCount++;
+            otherAgeSum += ages[row];
+        }
+    }
+    if (otherCount > 0)
+    {
+        results.push_back(CohortGroupResult{otherLabel, otherCount, static_cast<double>(otherAgeSum) / otherCount});
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const CohortGroupResult &a, const CohortGroupResult &b)
+              { return a.count != b.count ? a.count > b.count : a.label < b.label; });
+    return results;
+}
+
+size_t PatientColumns::memoryUsage() const
+{
+    return ids.capacity() * sizeof(int) + ages.capacity() * sizeof(int) +
+           registrationDays.capacity() * sizeof(int) +
+           genderCodes.capacity() + bloodGroupCodes.capacity() +
+           rowByID.size() * (sizeof(int) + sizeof(size_t) + 2 * sizeof(void *)) +
+           rowByID.bucket_count() * sizeof(void *);
+}
@@ -0,0 +1,124 @@
+#ifndef PATIENT_COLUMNS_H
+#define PATIENT_COLUMNS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct Patient;
+
+// Maps a low-cardinality string (gender, blood group) to a one-byte code
+class StringInterner {
+private:
+    std::vector<std::string> values;
+    std::unordered_map<std::string, unsigned char> codes;
+
+public:
+    static const int NOT_FOUND = -1;
+
+    unsigned char intern(const std::string& value);
+    int find(const std::string& value) const;
+    const std::string& value(unsigned char code) const;
+    size_t size() const;
+};
+
+// One bit per row of a PatientColumns store; predicates are combined with AND
+class SelectionBitmap {
+private:
+    std::vector<unsigned long long> words;
+    size_t rows;
+
+public:
+    explicit SelectionBitmap(size_t rowCount = 0, bool selected = true);
+
+    size_t size() const;
+    size_t wordCount() const;
+    unsigned long long word(size_t index) const;
+    void intersect(size_t index, unsigned long long bits);
+    void intersect(const SelectionBitmap& other);
+    void set(size_t row);
+    bool test(size_t row) const;
+    size_t count() const;
+};
+
+// Cohort predicates; unset bounds and empty strings match every row
+struct CohortFilter {
+    int minAge;
+    int maxAge;
+    std::string gender;
+    std::string bloodGroup;
+    int registeredFrom; // Day numbers from dateToDays(), -1 = open
+    int registeredTo;
+    bool byPatients;             // Restrict to patientIDs (e.g. one doctor's patients)
+    std::vector<int> patientIDs;
+
+    CohortFilter();
+};
+
+// A labelled set of patients, for grouping by a many-to-many relation such
+// as doctor assignments (a patient may fall in several sets)
+struct PatientSet {
+    std::string label;
+    std::vector<int> patientIDs;
+};
+
+enum CohortGroup {
+    GROUP_NONE,
+    GROUP_GENDER,
+    GROUP_BLOOD_GROUP,
+    GROUP_AGE_BAND,
+    GROUP_DOCTOR
+};
+
+// One row of a group-by result
+struct CohortGroupResult {
+    std::string label;
+    size_t count;
+    double averageAge;
+};
+
+// Column-oriented scan index over the patient records: one dense row per
+// patient holding only the fixed-width fields that cohort queries read.
+// Free-text fields (name, address, phone) stay in the record store and are
+// looked up by id(row). Deleting a row moves the last row into its slot.
+class PatientColumns {
+private:
+    std::vector<int> ids;
+    std::vector<int> ages;
+    std::vector<unsigned char> genderCodes;
+    std::vector<unsigned char> bloodGroupCodes;
+    std::vector<int> registrationDays; // dateToDays() of the registration date, -1 if unknown
+    std::unordered_map<int, size_t> rowByID;
+
+    StringInterner genders;
+    StringInterner bloodGroups;
+
+    template <typename Predicate>
+    void applyPredicate(SelectionBitmap& selection, Predicate matches) const;
+
+public:
+    void upsert(const Patient* patient);
+    void remove(int id);
+    void clear();
+    size_t size() const;
+
+    int id(size_t row) const;
+    int age(size_t row) const;
+    const std::string& gender(size_t row) const;
+    const std::string& bloodGroup(size_t row) const;
+
+    // Rows with minAge <= age <= maxAge and the given blood group ("" = any)
+    std::vector<size_t> filterByAgeAndBloodGroup(int minAge, int maxAge, const std::string& bloodGroup) const;
+
+    // Cohort engine: predicates evaluated column by column into a bitmap,
+    // then counted or grouped
+    SelectionBitmap select(const CohortFilter& filter) const;
+    SelectionBitmap rowsOf(const std::vector<int>& patientIDs) const;
+    std::vector<CohortGroupResult> groupBy(const SelectionBitmap& selection, CohortGroup group) const;
+    std::vector<CohortGroupResult> groupBySets(const SelectionBitmap& selection, const std::vector<PatientSet>& sets,
+                                               const std::string& otherLabel) const;
+
+    size_t memoryUsage() const;
+};
+
+#endif
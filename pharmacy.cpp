@@ -1,110 +1,165 @@
 #include "pharmacy.h"
+#include "recordFields.h"
 #include "utils.h"
 #include <iostream>
+#include <utility>
 #include <sstream>
 #include <algorithm>
 #include <fstream>
+#include <climits>
+#include <thread>
+#include <chrono>
 
 using namespace std;
 
-Medicine::Medicine(int id, string n, string cat, int qty, double p, string exp, string man): medicineID(id), name(n), category(cat), quantity(qty), price(p),expiryDate(exp), manufacturer(man), left(nullptr), right(nullptr) {}
-
-PharmacyManager::PharmacyManager() : root(nullptr) {
-    loadFromFile();
-}
-PharmacyManager::~PharmacyManager() {
-    saveToFile();
-    clearTree(root);
+MedicineLot::MedicineLot(int qty, string exp, string batch): quantity(qty), expiryDate(std::move(exp)), batchNumber(std::move(batch)), expiryDays(dateToDays(expiryDate)) {
+    if (expiryDays < 0) expiryDays = INT_MAX; // Unknown expiry is dispensed last
 }
-Medicine* PharmacyManager::insertBST(Medicine* node, Medicine* newMedicine) {
-    if (node == nullptr) return newMedicine;
 
-    if (newMedicine->medicineID < node->medicineID) {
-        node->left = insertBST(node->left, newMedicine);
-    } else if (newMedicine->medicineID > node->medicineID) {
-        node->right = insertBST(node->right, newMedicine);
-    }
+Medicine::Medicine(int id, string n, string cat, int qty, double p, string exp, string man): medicineID(id), name(std::move(n)), category(std::move(cat)), quantity(qty), price(p),expiryDate(std::move(exp)), manufacturer(std::move(man)), reorderLevel(0), reorderKey(0.0) {}
 
-    return node;
+// Heap comparator: the lot that expires first ends up at the front
+static bool expiresLater(const MedicineLot& a, const MedicineLot& b) {
+    return a.expiryDays > b.expiryDays;
 }
 
-Medicine* PharmacyManager::searchBST(Medicine* node, int id) {
-    if (node == nullptr || node->medicineID == id) return node;
+// Lots are stored as "qty expiry batch" entries separated by ';', in heap order
+struct LotListCodec {
+    static void write(ostream& out, const vector<MedicineLot>& lots) {
+        for (size_t i = 0; i < lots.size(); i++) {
+            const MedicineLot& lot = lots[i];
+            out << lot.quantity << " " << lot.expiryDate << " " << lot.batchNumber;
+            if (i < lots.size() - 1) out << ";";
+        }
+    }
+    static bool read(string& text, vector<MedicineLot>& lots) {
+        lots.clear();
+        istringstream lotsIss(text);
+        string entry;
+        while (getline(lotsIss, entry, ';')) {
+            istringstream lIss(entry);
+            int lotQty;
+            string lotExpiry, batchNumber;
+            if (lIss >> lotQty >> lotExpiry) {
+                getline(lIss, batchNumber);
+                if (!batchNumber.empty() && batchNumber[0] == ' ') batchNumber.erase(0, 1);
+                lots.emplace_back(lotQty, std::move(lotExpiry), std::move(batchNumber));
+            }
+        }
+        return true;
+    }
+};
 
-    if (id < node->medicineID) return searchBST(node->left, id);
-    else return searchBST(node->right, id);
-}
+// pharmacy.txt line: "id quantity price |name|category|expiryDate|manufacturer|lots|reorderLevel|"
+typedef RecordFormat<Medicine,
+                     FieldList<Field<Medicine, int, &Medicine::medicineID>,
+                               Field<Medicine, atomic<int>, &Medicine::quantity>,
+                               Field<Medicine, double, &Medicine::price>>,
+                     FieldList<Field<Medicine, string, &Medicine::name>,
+                               Field<Medicine, string, &Medicine::category>,
+                               Field<Medicine, string, &Medicine::expiryDate>,
+                               Field<Medicine, string, &Medicine::manufacturer>,
+                               Field<Medicine, vector<MedicineLot>, &Medicine::lots, LotListCodec>,
+                               Field<Medicine, int, &Medicine::reorderLevel>>>
+    MedicineFormat;
 
-Medicine* PharmacyManager::searchByName(Medicine* node, const string& name) {
-    if (node == nullptr) return nullptr;
+PharmacyManager::PharmacyManager()
+    : deltaLog(records, "pharmacy.txt", "pharmacy_delta.txt", MedicineFormat::write) {
+    // Attached indexes are updated by insert/erase, which run under treeMutex
+    // held exclusively; lot and stock changes re-index expiry and reorder
+    // entries themselves under indexMutex
+    records.attachIndex([this](Medicine& medicine) { indexName(&medicine); },
+                        [this](Medicine& medicine) { unindexName(&medicine); });
+    records.attachIndex([this](Medicine& medicine) { indexExpiry(&medicine); },
+                        [this](Medicine& medicine) { unindexExpiry(&medicine); });
+    records.attachIndex([this](Medicine& medicine) { indexReorder(&medicine); },
+                        [this](Medicine& medicine) { unindexReorder(&medicine); });
+    loadFromFile();
+}
+PharmacyManager::~PharmacyManager() {
+    compactFile();
+}
+Medicine* PharmacyManager::searchByName(const string& name) {
+    auto it = nameIndex.find(toLowerCase(name));
+    if (it == nameIndex.end()) return nullptr;
+    return records.find(it->second);
+}
 
-    string nodeName = node->name;
-    string searchName = name;
-    transform(nodeName.begin(), nodeName.end(), nodeName.begin(), ::tolower);
-    transform(searchName.begin(), searchName.end(), searchName.begin(), ::tolower);
+void PharmacyManager::indexName(Medicine* medicine) {
+    string key = toLowerCase(medicine->name);
+    nameIndex.emplace(key, medicine->medicineID);
+    sortedNameIndex.emplace(key, medicine->medicineID);
+}
 
-    if (nodeName == searchName) return node;
+void PharmacyManager::unindexName(Medicine* medicine) {
+    string key = toLowerCase(medicine->name);
+    auto range = nameIndex.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == medicine->medicineID) {
+            nameIndex.erase(it);
+            break;
+        }
+    }
+    sortedNameIndex.erase({key, medicine->medicineID});
+}
 
-    Medicine* leftResult = searchByName(node->left, name);
-    if (leftResult != nullptr) return leftResult;
+void PharmacyManager::indexExpiry(Medicine* medicine) {
+    int expiry = dateToDays(medicine->expiryDate);
+    if (expiry >= 0) expiryIndex.emplace(expiry, medicine->medicineID);
+}
 
-    return searchByName(node->right, name);
+void PharmacyManager::unindexExpiry(Medicine* medicine) {
+    int expiry = dateToDays(medicine->expiryDate);
+    if (expiry >= 0) expiryIndex.erase({expiry, medicine->medicineID});
 }
-Medicine* PharmacyManager::findMin(Medicine* node) {
-    while (node->left != nullptr) node = node->left;
-    return node;
+
+static double stockRatio(const Medicine* medicine) {
+    return static_cast<double>(medicine->quantity) / medicine->reorderLevel;
 }
-Medicine* PharmacyManager::deleteBST(Medicine* node, int id) {
-    if (node == nullptr) return node;
 
-    if (id < node->medicineID) node->left = deleteBST(node->left, id);
-    else if (id > node->medicineID) node->right = deleteBST(node->right, id);
-    else {
-        if (node->left == nullptr) {
-            Medicine* temp = node->right;
-            delete node;
-            return temp;
-        } else if (node->right == nullptr) {
-            Medicine* temp = node->left;
-            delete node;
-            return temp;
-        }
+void PharmacyManager::indexReorder(Medicine* medicine) {
+    if (medicine->reorderLevel <= 0) return;
+    medicine->reorderKey = stockRatio(medicine);
+    reorderIndex.emplace(medicine->reorderKey, medicine->medicineID);
+}
 
-        Medicine* temp = findMin(node->right);
-        node->medicineID = temp->medicineID;
-        node->name = temp->name;
-        node->category = temp->category;
-        node->quantity = temp->quantity;
-        node->price = temp->price;
-        node->expiryDate = temp->expiryDate;
-        node->manufacturer = temp->manufacturer;
+// Uses the stored key: reservations may have moved quantity since indexing
+void PharmacyManager::unindexReorder(Medicine* medicine) {
+    if (medicine->reorderLevel > 0) reorderIndex.erase({medicine->reorderKey, medicine->medicineID});
+}
 
-        node->right = deleteBST(node->right, temp->medicineID);
-    }
+void PharmacyManager::addLot(Medicine* medicine, int quantity, string expiryDate, string batchNumber) {
+    medicine->lots.emplace_back(quantity, std::move(expiryDate), std::move(batchNumber));
+    push_heap(medicine->lots.begin(), medicine->lots.end(), expiresLater);
+    medicine->quantity += quantity;
+}
 
-    return node;
+// Once every lot is used up the last known date is kept, so the medicine
+// stays in the expiry index and still shows a date
+void PharmacyManager::refreshExpiry(Medicine* medicine) {
+    if (!medicine->lots.empty()) medicine->expiryDate = medicine->lots.front().expiryDate;
 }
 
-void PharmacyManager::inorderTraversal(Medicine* node) {
-    if (node != nullptr) {
-        inorderTraversal(node->left);
-        cout << "----------------------------------------" << endl;
-        cout << "Medicine ID: " << node->medicineID << endl;
-        cout << "Name: " << node->name << endl;
-        cout << "Category: " << node->category << endl;
-        cout << "Quantity: " << node->quantity << endl;
-        cout << "Price: " << formatCurrency(node->price) << endl;
-        cout << "Expiry Date: " << node->expiryDate << endl;
-        cout << "Manufacturer: " << node->manufacturer << endl;
-        inorderTraversal(node->right);
-    }
+void PharmacyManager::displayMedicine(const Medicine& medicine) {
+    cout << "----------------------------------------" << endl;
+    cout << "Medicine ID: " << medicine.medicineID << endl;
+    cout << "Name: " << medicine.name << endl;
+    cout << "Category: " << medicine.category << endl;
+    cout << "Quantity: " << medicine.quantity << endl;
+    cout << "Price: " << formatCurrency(medicine.price) << endl;
+    cout << "Expiry Date: " << medicine.expiryDate << endl;
+    cout << "Manufacturer: " << medicine.manufacturer << endl;
+    cout << "Reorder Level: " << medicine.reorderLevel << endl;
+    cout << "Lots: " << medicine.lots.size() << endl;
 }
 
 void PharmacyManager::addMedicine() {
     clearScreen();
     cout << "========== ADD MEDICINE ==========" << endl << endl;
 
-    int id = generateID("pharmacy.txt");
+    // Next ID after the largest in memory (the data file may lag behind the delta log)
+    Medicine* lastMedicine = records.last();
+    int id = lastMedicine != nullptr ? lastMedicine->medicineID + 1 : 1;
     cout << "Generated Medicine ID: " << id << endl << endl;
 
     string name = getValidString("Enter Medicine Name: ");
@@ -113,35 +168,229 @@ void PharmacyManager::addMedicine() {
     double price = getValidInt("Enter Price: ");
     string expiryDate = getValidString("Enter Expiry Date (DD/MM/YYYY): ");
     string manufacturer = getValidString("Enter Manufacturer: ");
+    string batchNumber = getValidString("Enter Batch Number: ");
+    int reorderLevel = getValidInt("Enter Reorder Level (0 for none): ");
 
-    Medicine* newMedicine = new Medicine(id, name, category, quantity, price, expiryDate, manufacturer);
-    root = insertBST(root, newMedicine);
+    Medicine* newMedicine = records.create(id, std::move(name), std::move(category), 0, price, expiryDate, std::move(manufacturer));
+    newMedicine->reorderLevel = reorderLevel > 0 ? reorderLevel : 0;
+    if (quantity > 0) {
+        addLot(newMedicine, quantity, expiryDate, std::move(batchNumber));
+        refreshExpiry(newMedicine);
+    }
+    {
+        unique_lock<shared_mutex> lock(treeMutex);
+        records.insert(newMedicine);
+    }
+    deltaLog.markDirty(id);
 
     cout << "Medicine added successfully!" << endl;
     saveToFile();
     pause();
 }
-void PharmacyManager::updateStock(int medicineID, int quantity) {
-    Medicine* medicine = searchBST(root, medicineID);
+void PharmacyManager::receiveStock(int medicineID, int quantity, const string& expiryDate, const string& batchNumber) {
+    if (quantity <= 0) {
+        cout << "Quantity must be positive!" << endl;
+        return;
+    }
+    {
+        shared_lock<shared_mutex> treeLock(treeMutex);
+        Medicine* medicine = records.find(medicineID);
+        if (medicine == nullptr) {
+            cout << "Medicine with ID " << medicineID << " not found!" << endl;
+            return;
+        }
+
+        lock_guard<mutex> lotLock(lotLocks[medicineID % LOT_LOCK_SHARDS]);
+        lock_guard<mutex> indexLock(indexMutex);
+        unindexExpiry(medicine);
+        unindexReorder(medicine);
+        addLot(medicine, quantity, expiryDate, batchNumber);
+        refreshExpiry(medicine);
+        indexExpiry(medicine);
+        indexReorder(medicine);
+        deltaLog.markDirty(medicineID);
+
+        cout << "Stock received! New quantity: " << medicine->quantity << endl;
+    }
+    saveToFile();
+}
+
+// Reserve stock with a compare-and-swap loop so concurrent counters never
+// drive the quantity negative. The lots are not touched until commit.
+bool PharmacyManager::reserveStock(int medicineID, int quantity) {
+    if (quantity <= 0) return false;
+
+    shared_lock<shared_mutex> treeLock(treeMutex);
+    Medicine* medicine = records.find(medicineID);
+    if (medicine == nullptr) return false;
+
+    int available = medicine->quantity.load();
+    while (available >= quantity) {
+        if (medicine->quantity.compare_exchange_weak(available, available - quantity)) return true;
+    }
+    return false;
+}
+
+// Roll back a reservation that will not be dispensed
+void PharmacyManager::releaseStock(int medicineID, int quantity) {
+    shared_lock<shared_mutex> treeLock(treeMutex);
+    Medicine* medicine = records.find(medicineID);
+    if (medicine != nullptr) medicine->quantity += quantity;
+}
+
+// Consume a reservation from the lots, first-expiring-first-out
+void PharmacyManager::commitDispense(int medicineID, int quantity) {
+    shared_lock<shared_mutex> treeLock(treeMutex);
+    Medicine* medicine = records.find(medicineID);
+    if (medicine == nullptr) return;
+
+    lock_guard<mutex> lotLock(lotLocks[medicineID % LOT_LOCK_SHARDS]);
+    int remaining = quantity;
+    while (remaining > 0 && !medicine->lots.empty()) {
+        MedicineLot& lot = medicine->lots.front();
+        if (lot.quantity > remaining) {
+            lot.quantity -= remaining;
+            remaining = 0;
+        } else {
+            remaining -= lot.quantity;
+            pop_heap(medicine->lots.begin(), medicine->lots.end(), expiresLater);
+            medicine->lots.pop_back();
+        }
+    }
+
+    lock_guard<mutex> indexLock(indexMutex);
+    unindexExpiry(medicine);
+    unindexReorder(medicine);
+    refreshExpiry(medicine);
+    indexExpiry(medicine);
+    indexReorder(medicine);
+    deltaLog.markDirty(medicineID);
+}
+
+bool PharmacyManager::dispenseMedicine(int medicineID, int quantity) {
+    if (!medicineExists(medicineID)) {
+        cout << "Medicine with ID " << medicineID << " not found!" << endl;
+        return false;
+    }
+    if (!reserveStock(medicineID, quantity)) {
+        cout << "Insufficient stock! Available: " << records.find(medicineID)->quantity << endl;
+        return false;
+    }
+    commitDispense(medicineID, quantity);
+
+    Medicine* medicine = records.find(medicineID);
+    cout << "Dispensed " << quantity << " x " << medicine->name
+         << ". Remaining: " << medicine->quantity << endl;
+    if (medicine->reorderLevel > 0 && medicine->quantity <= medicine->reorderLevel) {
+        cout << "Low stock alert: reorder level is " << medicine->reorderLevel << endl;
+    }
+    saveToFile();
+    return true;
+}
+
+// Hammer one medicine from several threads and check that no update is lost.
+// Every reservation is rolled back, so the inventory is left unchanged.
+void PharmacyManager::runDispenseStressTest(int medicineID, int threadCount) {
+    Medicine* medicine = records.find(medicineID);
     if (medicine == nullptr) {
         cout << "Medicine with ID " << medicineID << " not found!" << endl;
         return;
     }
-    medicine->quantity += quantity;
-    if (medicine->quantity < 0) medicine->quantity = 0;
+    if (threadCount < 1) threadCount = 1;
+    int maxThreads = static_cast<int>(max(1u, thread::hardware_concurrency())) * 4;
+    if (threadCount > maxThreads) {
+        cout << "Using " << maxThreads << " threads (4 per hardware thread)." << endl;
+        threadCount = maxThreads;
+    }
 
-    cout << "Stock updated! New quantity: " << medicine->quantity << endl;
-    saveToFile();
+    const int OPS_PER_THREAD = 200000;
+    const int COMMITS_PER_THREAD = 20000;
+    int initial = medicine->quantity;
+    vector<thread> workers;
+
+    // Phase 1: reserve/release churn at full contention
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([this, medicineID, OPS_PER_THREAD]() {
+            for (int i = 0; i < OPS_PER_THREAD; i++) {
+                if (reserveStock(medicineID, 1)) releaseStock(medicineID, 1);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    bool churnOk = medicine->quantity == initial;
+
+    // Phase 2: drain the stock concurrently; exactly 'initial' reservations may succeed
+    atomic<int> granted(0);
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([this, medicineID, &granted]() {
+            while (reserveStock(medicineID, 1)) granted++;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    bool drainOk = granted == initial && medicine->quantity == 0;
+    releaseStock(medicineID, granted);
+    workers.clear();
+
+    // Phase 3: reserve-then-commit from every thread. Each commit must take
+    // exactly one unit from the lots and one from the quantity. The lots are
+    // restored afterwards, so the test leaves the stock as it found it.
+    vector<MedicineLot> savedLots = medicine->lots;
+    int lotsBefore = 0;
+    for (const MedicineLot& lot : medicine->lots) lotsBefore += lot.quantity;
+    atomic<int> committed(0);
+    for (int t = 0; t < threadCount; t++) {
+        workers.emplace_back([this, medicineID, COMMITS_PER_THREAD, &committed]() {
+            for (int i = 0; i < COMMITS_PER_THREAD && reserveStock(medicineID, 1); i++) {
+                commitDispense(medicineID, 1);
+                committed++;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    int lotsAfter = 0;
+    for (const MedicineLot& lot : medicine->lots) lotsAfter += lot.quantity;
+    bool commitOk = lotsBefore - lotsAfter == committed && initial - medicine->quantity == committed;
+    {
+        unique_lock<shared_mutex> treeLock(treeMutex);
+        lock_guard<mutex> indexLock(indexMutex);
+        unindexExpiry(medicine);
+        unindexReorder(medicine);
+        medicine->lots = savedLots;
+        medicine->quantity = initial;
+        refreshExpiry(medicine);
+        indexExpiry(medicine);
+        indexReorder(medicine);
+    }
+
+    cout << "========== DISPENSING STRESS TEST ==========" << endl;
+    cout << "Medicine: " << medicine->name << " (Initial Qty: " << initial << ")" << endl;
+    cout << "Threads: " << threadCount << endl;
+    cout << "Reserve/release ops: " << 2LL * threadCount * OPS_PER_THREAD << " in " << seconds << " s ("
+         << static_cast<long long>(2.0 * threadCount * OPS_PER_THREAD / seconds) << " ops/s)" << endl;
+    cout << "Quantity after churn: " << (churnOk ? "unchanged (PASS)" : "CHANGED (FAIL)") << endl;
+    cout << "Drain granted " << granted << " of " << initial << ": " << (drainOk ? "PASS" : "FAIL") << endl;
+    cout << "Reserve-then-commit: " << committed << " units, lots and quantity "
+         << (commitOk ? "agree (PASS)" : "DISAGREE (FAIL)") << endl;
+    cout << "Quantity restored to: " << medicine->quantity << endl;
+    cout << "============================================" << endl;
 }
+
 void PharmacyManager::removeMedicine(int medicineID) {
-    Medicine* medicine = searchBST(root, medicineID);
+    Medicine* medicine = records.find(medicineID);
     if (medicine == nullptr) {
         cout << "Medicine with ID " << medicineID << " not found!" << endl;
         pause();
         return;
     }
     cout << "Removing medicine: " << medicine->name << endl;
-    root = deleteBST(root, medicineID);
+    {
+        unique_lock<shared_mutex> lock(treeMutex);
+        records.erase(medicineID);
+    }
+    deltaLog.markDeleted(medicineID);
     cout << "Medicine removed successfully!" << endl;
     saveToFile();
     pause();
@@ -149,16 +398,16 @@ void PharmacyManager::removeMedicine(int medicineID) {
 void PharmacyManager::viewInventory() {
     clearScreen();
     cout << "========== PHARMACY INVENTORY ==========" << endl;
-    if (root == nullptr) {
+    if (records.empty()) {
         cout << "No medicines in inventory." << endl;
     } else {
-        inorderTraversal(root);
+        records.forEach([this](const Medicine& medicine) { displayMedicine(medicine); });
     }
     cout << "========================================" << endl;
     pause();
 }
 void PharmacyManager::viewMedicine(int medicineID) {
-    Medicine* medicine = searchBST(root, medicineID);
+    Medicine* medicine = records.find(medicineID);
     if (medicine != nullptr) {
         cout << "========== MEDICINE DETAILS ==========" << endl;
         cout << "Medicine ID: " << medicine->medicineID << endl;
@@ -168,13 +417,22 @@ void PharmacyManager::viewMedicine(int medicineID) {
         cout << "Price: " << formatCurrency(medicine->price) << endl;
         cout << "Expiry Date: " << medicine->expiryDate << endl;
         cout << "Manufacturer: " << medicine->manufacturer << endl;
+        if (!medicine->lots.empty()) {
+            vector<MedicineLot> lots = medicine->lots;
+            sort_heap(lots.begin(), lots.end(), expiresLater);
+            cout << "Lots (first to expire first):" << endl;
+            for (auto it = lots.rbegin(); it != lots.rend(); ++it) {
+                cout << "  Batch " << it->batchNumber << ": " << it->quantity
+                     << " (Expiry: " << it->expiryDate << ")" << endl;
+            }
+        }
         cout << "=====================================" << endl;
     } else {
         cout << "Medicine with ID " << medicineID << " not found!" << endl;
     }
 }
 void PharmacyManager::searchMedicineByName(const string& name) {
-    Medicine* medicine = searchByName(root, name);
+    Medicine* medicine = searchByName(name);
     if (medicine != nullptr) {
         viewMedicine(medicine->medicineID);
     } else {
@@ -182,64 +440,226 @@ void PharmacyManager::searchMedicineByName(const string& name) {
     }
 }
 
+vector<int> PharmacyManager::findMedicinesByPrefix(const string& prefix, size_t limit) {
+    vector<int> ids;
+    string key = toLowerCase(prefix);
+    for (auto it = sortedNameIndex.lower_bound({key, 0});
+         it != sortedNameIndex.end() && ids.size() < limit; ++it) {
+        if (it->first.compare(0, key.size(), key) != 0) break;
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+void PharmacyManager::searchMedicineByPrefix(const string& prefix) {
+    vector<int> ids = findMedicinesByPrefix(prefix);
+    if (ids.empty()) {
+        cout << "No medicines starting with '" << prefix << "'." << endl;
+        return;
+    }
+    cout << "========== MATCHING MEDICINES ==========" << endl;
+    for (int id : ids) {
+        Medicine* medicine = records.find(id);
+        cout << medicine->medicineID << ". " << medicine->name
+             << " (Qty: " << medicine->quantity << ")" << endl;
+    }
+    cout << "========================================" << endl;
+}
+
+vector<int> PharmacyManager::findExpiringWithin(int days) {
+    vector<int> ids;
+    if (days < 0) return ids; // The range end would come before its start
+    int today = dateToDays(getCurrentDate());
+    int until = days > INT_MAX - today ? INT_MAX : today + days;
+    auto last = expiryIndex.upper_bound({until, INT_MAX});
+    for (auto it = expiryIndex.lower_bound({today, 0}); it != last; ++it) {
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+void PharmacyManager::viewExpiringMedicines(int days) {
+    vector<int> ids = findExpiringWithin(days);
+    cout << "========== EXPIRING WITHIN " << days << " DAYS ==========" << endl;
+    if (ids.empty()) {
+        cout << "No medicines expiring in this period." << endl;
+    }
+    for (int id : ids) {
+        Medicine* medicine = records.find(id);
+        cout << medicine->medicineID << ". " << medicine->name
+             << " (Qty: " << medicine->quantity << ", Expiry: " << medicine->expiryDate << ")" << endl;
+    }
+    cout << "========================================" << endl;
+}
+
+// Returns true if at least one lot was removed
+bool PharmacyManager::quarantineExpiredLots(Medicine* medicine, int today, ofstream& file) {
+    bool removed = false;
+    while (!medicine->lots.empty() && medicine->lots.front().expiryDays < today) {
+        const MedicineLot& lot = medicine->lots.front();
+        file << medicine->medicineID << " " << lot.quantity << " |" << medicine->name << "|"
+             << lot.expiryDate << "|" << lot.batchNumber << "|" << getCurrentDate() << "|" << endl;
+        cout << "Quarantined " << lot.quantity << " x " << medicine->name
+             << " (batch " << lot.batchNumber << ", expired " << lot.expiryDate << ")" << endl;
+        medicine->quantity -= lot.quantity;
+        pop_heap(medicine->lots.begin(), medicine->lots.end(), expiresLater);
+        medicine->lots.pop_back();
+        removed = true;
+    }
+    refreshExpiry(medicine);
+    return removed;
+}
+
+int PharmacyManager::quarantineExpired() {
+    int today = dateToDays(getCurrentDate());
+    vector<Medicine*> expired;
+    int quarantined = 0;
+    {
+        unique_lock<shared_mutex> lock(treeMutex);
+        auto last = expiryIndex.lower_bound({today, 0});
+        if (last == expiryIndex.begin()) return 0;
+
+        ofstream file("quarantine.txt", ios::app);
+        for (auto it = expiryIndex.begin(); it != last; ++it) {
+            Medicine* medicine = records.find(it->second);
+            unindexReorder(medicine);
+            if (quarantineExpiredLots(medicine, today, file)) {
+                deltaLog.markDirty(medicine->medicineID);
+                quarantined++;
+            }
+            indexReorder(medicine);
+            expired.push_back(medicine);
+        }
+        expiryIndex.erase(expiryIndex.begin(), last);
+        for (Medicine* medicine : expired) indexExpiry(medicine);
+        file.close();
+    }
+    saveToFile();
+    return quarantined;
+}
+
+void PharmacyManager::runExpirySweep() {
+    clearScreen();
+    cout << "========== DAILY EXPIRY SWEEP ==========" << endl << endl;
+    int count = quarantineExpired();
+    cout << count << " expired medicine(s) moved to quarantine." << endl << endl;
+    viewExpiringMedicines(30);
+}
+
+void PharmacyManager::setReorderLevel(int medicineID, int level) {
+    Medicine* medicine = records.find(medicineID);
+    if (medicine == nullptr) {
+        cout << "Medicine with ID " << medicineID << " not found!" << endl;
+        return;
+    }
+    {
+        lock_guard<mutex> indexLock(indexMutex);
+        unindexReorder(medicine);
+        medicine->reorderLevel = level > 0 ? level : 0;
+        indexReorder(medicine);
+    }
+    deltaLog.markDirty(medicineID);
+
+    cout << "Reorder level for " << medicine->name << " set to " << medicine->reorderLevel << endl;
+    saveToFile();
+}
+
+// Medicines at or below their reorder level, most depleted first
+vector<int> PharmacyManager::findMedicinesToReorder() {
+    vector<int> ids;
+    for (auto it = reorderIndex.begin(); it != reorderIndex.end() && it->first <= 1.0; ++it) {
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+void PharmacyManager::viewReorderReport() {
+    clearScreen();
+    cout << "========== REORDER REPORT ==========" << endl;
+    vector<int> ids = findMedicinesToReorder();
+    if (ids.empty()) {
+        cout << "All medicines are above their reorder levels." << endl;
+    }
+    for (int id : ids) {
+        Medicine* medicine = records.find(id);
+        // Suggest restocking to twice the reorder level
+        int suggested = 2 * medicine->reorderLevel - medicine->quantity;
+        cout << medicine->medicineID << ". " << medicine->name
+             << " (Qty: " << medicine->quantity << ", Reorder Level: " << medicine->reorderLevel
+             << ", Suggested Order: " << suggested << ")" << endl;
+    }
+    cout << "====================================" << endl;
+}
+
 bool PharmacyManager::medicineExists(int id) {
-    return searchBST(root, id) != nullptr;
+    return records.find(id) != nullptr;
 }
 
 double PharmacyManager::getMedicinePrice(int id) {
-    Medicine* medicine = searchBST(root, id);
+    Medicine* medicine = records.find(id);
     if (medicine != nullptr) return medicine->price;
     return 0.0;
 }
-void PharmacyManager::loadFromFile() {
-    ifstream file("pharmacy.txt");
-    if (!file.is_open()) return;
-
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-
-        istringstream iss(line);
-        int id, quantity;
-        double price;
-        string name, category, expiryDate, manufacturer;
-        if (iss >> id >> quantity >> price) {
-            getline(iss, name, '|');
-            getline(iss, name, '|');
-            getline(iss, category, '|');
-            getline(iss, expiryDate, '|');
-            getline(iss, manufacturer, '|');
-
-            if (!name.empty() && name[0] == ' ') name = name.substr(1);
-
-            Medicine* newMedicine = new Medicine(id, name, category, quantity, price, expiryDate, manufacturer);
-            root = insertBST(root, newMedicine);
-        }
-    }
-    file.close();
+
+string PharmacyManager::getMedicineName(int id) {
+    Medicine* medicine = records.find(id);
+    if (medicine != nullptr) return medicine->name;
+    return "";
+}
+
+int PharmacyManager::getMedicineQuantity(int id) {
+    Medicine* medicine = records.find(id);
+    if (medicine != nullptr) return medicine->quantity.load();
+    return 0;
 }
-void PharmacyManager::saveToFileHelper(Medicine* node, ofstream& file) {
-    if (node != nullptr) {
-        saveToFileHelper(node->left, file);
-        file << node->medicineID << " " << node->quantity << " " << node->price
-             << " |" << node->name << "|" << node->category << "|" 
-             << node->expiryDate << "|" << node->manufacturer << "|" << endl;
-        saveToFileHelper(node->right, file);
+Medicine* PharmacyManager::parseRecord(const string& line) {
+    Medicine* newMedicine = records.create(0, "", "", 0, 0.0, "", "");
+    if (!MedicineFormat::read(line, *newMedicine)) {
+        records.destroy(newMedicine);
+        return nullptr;
     }
+
+    // Stock is the sum of the lots; a pre-lot record becomes a single lot
+    if (newMedicine->lots.empty()) {
+        int quantity = newMedicine->quantity;
+        newMedicine->quantity = 0;
+        if (quantity > 0) addLot(newMedicine, quantity, newMedicine->expiryDate, "-");
+    } else {
+        int quantity = 0;
+        for (const MedicineLot& lot : newMedicine->lots) quantity += lot.quantity;
+        newMedicine->quantity = quantity;
+        make_heap(newMedicine->lots.begin(), newMedicine->lots.end(), expiresLater);
+        refreshExpiry(newMedicine);
+    }
+    return newMedicine;
 }
 
+// Load the last full snapshot, then replay the delta log over it: record
+// lines replace or add a medicine, "-<id>" lines remove one
+void PharmacyManager::loadFromFile() {
+    deltaLog.replay(
+        [this](const string& line, bool fromDelta) {
+            Medicine* newMedicine = parseRecord(line);
+            if (newMedicine == nullptr) return;
+            if (records.contains(newMedicine->medicineID)) {
+                if (!fromDelta) {
+                    records.destroy(newMedicine);
+                    return;
+                }
+                records.erase(newMedicine->medicineID);
+            }
+            records.insert(newMedicine);
+        },
+        [this](int id) { records.erase(id); });
+}
+// Append the medicines changed since the last save to the delta log; the
+// full file is rewritten once the log outgrows the number of medicines
 void PharmacyManager::saveToFile() {
-    ofstream file("pharmacy.txt");
-    if (file.is_open()) {
-        saveToFileHelper(root, file);
-        file.close();
-    }
+    unique_lock<shared_mutex> treeLock(treeMutex);
+    deltaLog.save();
 }
 
-void PharmacyManager::clearTree(Medicine* node) {
-    if (node != nullptr) {
-        clearTree(node->left);
-        clearTree(node->right);
-        delete node;
-    }
+void PharmacyManager::compactFile() {
+    unique_lock<shared_mutex> treeLock(treeMutex);
+    deltaLog.compact();
 }
@@ -3,39 +3,88 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include "indexedStore.h"
+#include "deltaLog.h"
+
+// Medicine lot structure (one received shipment of a medicine)
+struct MedicineLot {
+    int quantity;
+    std::string expiryDate;
+    std::string batchNumber;
+    int expiryDays; // Parsed expiry date used for FEFO ordering
+    
+    MedicineLot(int qty, std::string exp, std::string batch);
+};
 
 // Medicine structure
 struct Medicine {
     int medicineID;
     std::string name;
     std::string category; // Antibiotic, Painkiller, Vitamin, etc.
-    int quantity;
+    std::atomic<int> quantity; // Available quantity (lots minus outstanding reservations)
     double price;
-    std::string expiryDate;
+    std::string expiryDate; // Expiry of the first-expiring lot
     std::string manufacturer;
+    int reorderLevel;   // Reorder when quantity falls to this level (0 = never)
+    double reorderKey;  // Key this medicine is stored under in the reorder index
     
-    // BST pointers
-    Medicine* left;
-    Medicine* right;
+    // Lots kept as a min-heap on expiry (first-expiring lot at the front)
+    std::vector<MedicineLot> lots;
     
     // Constructor
     Medicine(int id, std::string n, std::string cat, int qty, double p, std::string exp, std::string man);
 };
 
+typedef IndexedStore<Medicine, int, &Medicine::medicineID> MedicineStore;
+
 // Pharmacy Management Class using BST
 class PharmacyManager {
 private:
-    Medicine* root;
+    MedicineStore records; // Guarded by treeMutex
+    
+    // Name indexes (keyed by lowercased name, values are medicine IDs)
+    std::unordered_multimap<std::string, int> nameIndex;   // exact match
+    std::set<std::pair<std::string, int>> sortedNameIndex; // prefix search
+    
+    // Expiry index ordered by (expiry day number, medicine ID)
+    std::set<std::pair<int, int>> expiryIndex;
+    
+    // Reorder index ordered by (quantity / reorder level, medicine ID)
+    std::set<std::pair<double, int>> reorderIndex;
+    
+    // Concurrency control for dispensing counters. Lookups and stock
+    // reservations only take treeMutex shared; add/remove/save take it
+    // exclusively. Lot heaps are guarded by a lock shard per medicine ID
+    // and the ordered indexes above by indexMutex.
+    static const int LOT_LOCK_SHARDS = 16;
+    std::shared_mutex treeMutex;
+    std::mutex lotLocks[LOT_LOCK_SHARDS];
+    std::mutex indexMutex;
+    
+    // Incremental persistence: changed records are appended to
+    // pharmacy_delta.txt and folded into pharmacy.txt on compaction.
+    // Saving and compaction hold treeMutex exclusively.
+    DeltaLog<MedicineStore> deltaLog;
     
     // Helper functions
-    Medicine* insertBST(Medicine* node, Medicine* newMedicine);
-    Medicine* searchBST(Medicine* node, int id);
-    Medicine* searchByName(Medicine* node, const std::string& name);
-    Medicine* deleteBST(Medicine* node, int id);
-    Medicine* findMin(Medicine* node);
-    void inorderTraversal(Medicine* node);
-    void saveToFileHelper(Medicine* node, std::ofstream& file);
-    void clearTree(Medicine* node);
+    Medicine* searchByName(const std::string& name);
+    void indexName(Medicine* medicine);
+    void unindexName(Medicine* medicine);
+    void indexExpiry(Medicine* medicine);
+    void unindexExpiry(Medicine* medicine);
+    void indexReorder(Medicine* medicine);
+    void unindexReorder(Medicine* medicine);
+    void addLot(Medicine* medicine, int quantity, std::string expiryDate, std::string batchNumber);
+    void refreshExpiry(Medicine* medicine);
+    bool quarantineExpiredLots(Medicine* medicine, int today, std::ofstream& file);
+    void displayMedicine(const Medicine& medicine);
+    Medicine* parseRecord(const std::string& line);
     
 public:
     PharmacyManager();
@@ -43,19 +92,42 @@ public:
     
     // Main functions
     void addMedicine();
-    void updateStock(int medicineID, int quantity);
+    void receiveStock(int medicineID, int quantity, const std::string& expiryDate, const std::string& batchNumber);
+    bool dispenseMedicine(int medicineID, int quantity);
+    
+    // Thread-safe dispensing: reserve (lock-free CAS), then commit or release
+    bool reserveStock(int medicineID, int quantity);
+    void releaseStock(int medicineID, int quantity);
+    void commitDispense(int medicineID, int quantity);
+    void runDispenseStressTest(int medicineID, int threadCount);
     void removeMedicine(int medicineID);
     void viewInventory();
     void viewMedicine(int medicineID);
     void searchMedicineByName(const std::string& name);
+    void searchMedicineByPrefix(const std::string& prefix);
+    std::vector<int> findMedicinesByPrefix(const std::string& prefix, size_t limit = 10);
+    
+    // Reorder tracking
+    void setReorderLevel(int medicineID, int level);
+    std::vector<int> findMedicinesToReorder();
+    void viewReorderReport();
+    
+    // Expiry tracking
+    std::vector<int> findExpiringWithin(int days);
+    void viewExpiringMedicines(int days);
+    int quarantineExpired();
+    void runExpirySweep();
     
     // File operations
     void loadFromFile();
     void saveToFile();
+    void compactFile();
     
     // Check if medicine exists
     bool medicineExists(int id);
     double getMedicinePrice(int id);
+    std::string getMedicineName(int id);
+    int getMedicineQuantity(int id);
 };
 
 #endif
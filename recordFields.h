@@ -0,0 +1,146 @@
+#ifndef RECORD_FIELDS_H
+#define RECORD_FIELDS_H
+
+#include <atomic>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Compile-time field descriptors for the record lines the managers persist:
+//
+//     <head field> <head field> ... |<body field>|<body field>|...|
+//
+// A RecordFormat names each field once (member pointer plus codec) and
+// expands to straight-line write/read code for that record type, so the
+// Patient, Doctor and Medicine formats share one parser. Body fields missing
+// from an older, shorter line keep the value the record was created with.
+
+// Text conversion for one field type. read() may consume `text`.
+template <typename T>
+struct FieldCodec;
+
+template <>
+struct FieldCodec<int> {
+    static void write(std::ostream& out, int value) { out << value; }
+    static bool read(std::string& text, int& value) {
+        char* end = nullptr;
+        long parsed = std::strtol(text.c_str(), &end, 10);
+        if (end == text.c_str()) return false;
+        value = static_cast<int>(parsed);
+        return true;
+    }
+};
+
+template <>
+struct FieldCodec<std::atomic<int>> {
+    static void write(std::ostream& out, const std::atomic<int>& value) { out << value.load(); }
+    static bool read(std::string& text, std::atomic<int>& value) {
+        int parsed = 0;
+        if (!FieldCodec<int>::read(text, parsed)) return false;
+        value.store(parsed);
+        return true;
+    }
+};
+
+template <>
+struct FieldCodec<double> {
+    static void write(std::ostream& out, double value) { out << value; }
+    static bool read(std::string& text, double& value) {
+        char* end = nullptr;
+        double parsed = std::strtod(text.c_str(), &end);
+        if (end == text.c_str()) return false;
+        value = parsed;
+        return true;
+    }
+};
+
+template <>
+struct FieldCodec<std::string> {
+    static void write(std::ostream& out, const std::string& value) { out << value; }
+    static bool read(std::string& text, std::string& value) {
+        value.swap(text);
+        return true;
+    }
+};
+
+// Space-separated list of IDs
+template <>
+struct FieldCodec<std::vector<int>> {
+    static void write(std::ostream& out, const std::vector<int>& values) {
+        for (size_t i = 0; i < values.size(); i++) {
+            if (i > 0) out << " ";
+            out << values[i];
+        }
+    }
+    static bool read(std::string& text, std::vector<int>& values) {
+        values.clear();
+        const char* cursor = text.c_str();
+        char* end = nullptr;
+        for (long parsed = std::strtol(cursor, &end, 10); end != cursor; parsed = std::strtol(cursor, &end, 10)) {
+            values.push_back(static_cast<int>(parsed));
+            cursor = end;
+        }
+        return true;
+    }
+};
+
+// One persisted member of Record
+template <typename Record, typename T, T Record::*Member, typename Codec = FieldCodec<T>>
+struct Field {
+    static void write(const Record& record, std::ostream& out) { Codec::write(out, record.*Member); }
+    static bool read(Record& record, std::string text) { return Codec::read(text, record.*Member); }
+};
+
+template <typename... Fields>
+struct FieldList {};
+
+template <typename Record, typename Head, typename Body>
+class RecordFormat;
+
+template <typename Record, typename... HeadFields, typename... BodyFields>
+class RecordFormat<Record, FieldList<HeadFields...>, FieldList<BodyFields...>> {
+private:
+    // Next space-separated token before `end`
+    static std::string nextToken(const std::string& line, size_t& pos, size_t end) {
+        while (pos < end && line[pos] == ' ') pos++;
+        size_t start = pos;
+        while (pos < end && line[pos] != ' ') pos++;
+        return line.substr(start, pos - start);
+    }
+
+    template <typename BodyField>
+    static void readBody(const std::string& line, size_t& pos, Record& record) {
+        if (pos >= line.size()) return;
+        size_t next = line.find('|', pos);
+        if (next == std::string::npos) next = line.size();
+        BodyField::read(record, line.substr(pos, next - pos));
+        pos = next + 1;
+    }
+
+public:
+    static void write(const Record& record, std::ostream& out) {
+        bool first = true;
+        ((out << (first ? "" : " "), HeadFields::write(record, out), first = false), ...);
+        out << " |";
+        ((BodyFields::write(record, out), out << "|"), ...);
+        out << "\n";
+    }
+
+    // False if a head field is missing or malformed
+    static bool read(const std::string& line, Record& record) {
+        size_t bar = line.find('|');
+        size_t headEnd = bar == std::string::npos ? line.size() : bar;
+        size_t pos = 0;
+        bool valid = true;
+        ((valid = valid && HeadFields::read(record, nextToken(line, pos, headEnd))), ...);
+        if (!valid) return false;
+
+        pos = headEnd + 1;
+        if (pos < line.size() && line[pos] == ' ') pos++; // Older files wrote "| name"
+        (readBody<BodyFields>(line, pos, record), ...);
+        return true;
+    }
+};
+
+#endif
@@ -1,6 +1,15 @@
 #include "utils.h"
 #include <limits>
 #include <cstdlib>
+#include <cctype>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
 int getValidInt(const std::string &prompt)
 {
@@ -68,6 +77,29 @@ std::string getCurrentDate()
     return oss.str();
 }
 
+int dateToDays(const std::string &date)
+{
+    int day, month, year;
+    char sep1, sep2;
+    std::istringstream iss(date);
+    if (!(iss >> day >> sep1 >> month >> sep2 >> year) || sep1 != '/' || sep2 != '/')
+    {
+        return -1;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+    {
+        return -1;
+    }
+
+    // Days since 01/01/1970 (proleptic Gregorian calendar)
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
 void clearScreen()
 {
 #ifdef _WIN32
@@ -77,6 +109,17 @@ void clearScreen()
 #endif
 }
 
+bool replaceFile(const std::string &source, const std::string &target)
+{
+#ifdef _WIN32
+    // rename() refuses to overwrite an existing file on Windows
+    return MoveFileExA(source.c_str(), target.c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(source.c_str(), target.c_str()) == 0;
+#endif
+}
+
 void pause()
 {
     std::cout << "\nPress Enter to continue...";
@@ -90,3 +133,213 @@ std::string formatCurrency(double amount)
     oss << std::fixed << std::setprecision(2) << "Rs. " << amount;
     return oss.str();
 }
+
+std::string toLowerCase(const std::string &text)
+{
+    std::string lowered(text);
+    for (char &c : lowered)
+    {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lowered;
+}
+
+// Myers/Hyyro bit-parallel edit distance: one column of the DP matrix is
+// kept as vertical +1/-1 delta bit vectors, so each character of the text
+// costs a handful of word operations instead of a full column update.
+static int bitParallelDistance(const std::string &pattern, const std::string &text)
+{
+    unsigned long long peq[256] = {0};
+    size_t m = pattern.size();
+    for (size_t i = 0; i < m; i++)
+    {
+        peq[static_cast<unsigned char>(pattern[i])] |= 1ULL << i;
+    }
+
+    unsigned long long pv = (m == 64) ? ~0ULL : ((1ULL << m) - 1);
+    unsigned long long mv = 0;
+    unsigned long long last = 1ULL << (m - 1);
+    int score = static_cast<int>(m);
+
+    for (char c : text)
+    {
+        unsigned long long eq = peq[static_cast<unsigned char>(c)];
+        unsigned long long xv = eq | mv;
+        unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq;
+        unsigned long long ph = mv | ~(xh | pv);
+        unsigned long long mh = pv & xh;
+
+        if (ph & last)
+            score++;
+        else if (mh & last)
+            score--;
+
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+int editDistance(const std::string &a, const std::string &b)
+{
+    const std::string &pattern = a.size() <= b.size() ? a : b;
+    const std::string &text = a.size() <= b.size() ? b : a;
+
+    if (pattern.empty())
+    {
+        return static_cast<int>(text.size());
+    }
+    if (pattern.size() <= 64)
+    {
+        return bitParallelDistance(pattern, text);
+    }
+
+    // Long strings: classic two-row dynamic programming
+    std::vector<int> previous(pattern.size() + 1), current(pattern.size() + 1);
+    for (size_t i = 0; i <= pattern.size(); i++)
+    {
+        previous[i] = static_cast<int>(i);
+    }
+    for (size_t j = 1; j <= text.size(); j++)
+    {
+        current[0] = static_cast<int>(j);
+        for (size_t i = 1; i <= pattern.size(); i++)
+        {
+            int substitution = previous[i - 1] + (pattern[i - 1] == text[j - 1] ? 0 : 1);
+            current[i] = std::min(substitution, std::min(previous[i], current[i - 1]) + 1);
+        }
+        previous.swap(current);
+    }
+    return previous[pattern.size()];
+}
+
+std::string normalizeCode(const std::string &code)
+{
+    std::string key;
+    for (char c : code)
+    {
+        if (c != ' ')
+        {
+            key += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+    return key;
+}
+
+std::string normalizePhone(const std::string &phone)
+{
+    std::string digits;
+    for (char c : phone)
+    {
+        if (std::isdigit(static_cast<unsigned char>(c)))
+        {
+            digits += c;
+        }
+    }
+    return digits;
+}
+
+#ifdef HMS_COUNT_ALLOCATIONS
+// Benchmark builds only (-DHMS_COUNT_ALLOCATIONS): the replaceable global
+// allocation functions are overridden to count heap allocations. Every
+// plain, array and nothrow form is replaced together so each block is freed
+// by the matching function; the over-aligned forms stay with the library.
+static std::atomic<unsigned long long> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+    {
+        size = 1;
+    }
+    for (;;)
+    {
+        void *block = std::malloc(size);
+        if (block != nullptr)
+        {
+            return block;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return ::operator new(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void *block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void *block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void *block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void *block, const std::nothrow_t &) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void *block, const std::nothrow_t &) noexcept
+{
+    std::free(block);
+}
+
+bool heapAllocationsCounted()
+{
+    return true;
+}
+
+unsigned long long heapAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+#else
+bool heapAllocationsCounted()
+{
+    return false;
+}
+
+unsigned long long heapAllocationCount()
+{
+    return 0;
+}
+#endif
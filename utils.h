@@ -22,6 +22,9 @@ int generateID(const std::string& filename);
 // Function to get current date as string
 std::string getCurrentDate();
 
+// Function to convert a DD/MM/YYYY date to a day number (-1 if invalid)
+int dateToDays(const std::string& date);
+
 // Function to clear screen (cross-platform)
 void clearScreen();
 
@@ -31,6 +34,28 @@ void pause();
 // Function to format currency
 std::string formatCurrency(double amount);
 
+// Function to lowercase a string (used for case-insensitive lookups)
+std::string toLowerCase(const std::string& text);
+
+// Function to normalize a categorical code: upper case, spaces removed ("ab +" -> "AB+")
+std::string normalizeCode(const std::string& code);
+
+// Function to reduce a phone number to its digits (used as a lookup key)
+std::string normalizePhone(const std::string& phone);
+
+// Function to compute the Levenshtein distance between two strings
+// (bit-parallel for strings up to 64 characters)
+int editDistance(const std::string& a, const std::string& b);
+
+// Function to replace a file with another in one step (used to publish a
+// fully written snapshot); returns false if the target was left untouched
+bool replaceFile(const std::string& source, const std::string& target);
+
+// Functions to count heap allocations for the benchmarks; counting is only
+// compiled in with -DHMS_COUNT_ALLOCATIONS, otherwise the count stays 0
+bool heapAllocationsCounted();
+unsigned long long heapAllocationCount();
+
 #endif
 
 